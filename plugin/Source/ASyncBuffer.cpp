@@ -9,17 +9,22 @@
 */
 
 #include "ASyncBuffer.h"
+#include <numeric>
 
-ASyncBuffer::ASyncBuffer(int numChannels, int size) : abstractFifo(size)
+template <typename SampleType, typename Layout, int NumChannels>
+ASyncBuffer<SampleType, Layout, NumChannels>::ASyncBuffer(int initialNumChannels, int size) : abstractFifo(size), samples(nullptr), numChannels(initialNumChannels), capacity(0), channelSpan(0), mainReader(*this, 0)
 {
-    circularBuffer.setSize(numChannels,size);
+    jassert(NumChannels == 0 || numChannels == NumChannels);
+    resize(size);
 }
 
-ASyncBuffer::~ASyncBuffer()
+template <typename SampleType, typename Layout, int NumChannels>
+ASyncBuffer<SampleType, Layout, NumChannels>::~ASyncBuffer()
 {
 }
 
-void ASyncBuffer::push(juce::dsp::AudioBlock<float> inBuffer, int numToWrite, int numToMark)
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::push(Block inBuffer, int numToWrite, int numToMark)
 {
     if(numToWrite < 0)
     {
@@ -30,159 +35,637 @@ void ASyncBuffer::push(juce::dsp::AudioBlock<float> inBuffer, int numToWrite, in
         numToMark = numToWrite;
     }
 
-    auto circBuffer = juce::dsp::AudioBlock<float>(circularBuffer);
-    if(inBuffer.getNumChannels() > circBuffer.getNumChannels())
+    int start1, size1, start2, size2;
+    auto sequence = writeSequence.load(std::memory_order_relaxed);
+    if(canOverwrite)
     {
-        inBuffer = inBuffer.getSubsetChannelBlock(0, circBuffer.getNumChannels());
+        // we own the head and just carry on, the reader finds out what it missed when it next reads
+        jassert(numToWrite <= capacity);
+        getSegments(sequence, numToWrite, start1, size1, start2, size2);
     }
-    else if(inBuffer.getNumChannels() < circBuffer.getNumChannels())
+    else
     {
-        circBuffer = circBuffer.getSubsetChannelBlock(0, inBuffer.getNumChannels());
+        abstractFifo.prepareToWrite(numToWrite, start1, size1, start2, size2);
+        jassert(numToWrite == size1+size2);
     }
 
-    if(canOverwrite && numToWrite > abstractFifo.getFreeSpace())
+    // announce how far the write reaches before making it, a reader that still sees the old reach after reading is safe
+    writeReach.store(sequence + numToWrite, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    write(inBuffer, start1, size1, start2, size2);
+
+    if(!canOverwrite)
     {
-        int cut = numToWrite - abstractFifo.getFreeSpace();
-        trim(cut);
-        jassert(abstractFifo.getFreeSpace() >= numToWrite);
+        abstractFifo.finishedWrite(numToMark);
     }
+    writeSequence.store(sequence + numToMark, std::memory_order_release);
+}
 
-    int start1, size1, start2, size2;
-    abstractFifo.prepareToWrite(numToWrite, start1, size1, start2, size2);
-    jassert(numToWrite == size1+size2);
-
-    if(size1 > 0)
+template <typename SampleType, typename Layout, int NumChannels>
+typename ASyncBuffer<SampleType, Layout, NumChannels>::Delta ASyncBuffer<SampleType, Layout, NumChannels>::pop(Block outBuffer, int numToRead, int numToMark)
+{
+    if(numToRead < 0)
     {
-        auto circularChunk = circBuffer.getSubBlock(size_t(start1), size_t(size1));
-        auto bufferChunk = inBuffer.getSubBlock(0, size_t(size1));
-        circularChunk.copyFrom(bufferChunk);
+        numToRead = (int)outBuffer.getNumSamples();
     }
-    if(size2 > 0)
+    if(numToMark < 0)
+    {
+        numToMark = numToRead;
+    }
+
+    if(canOverwrite)
     {
-        auto circularChunk = circBuffer.getSubBlock(size_t(start2), size_t(size2));
-        auto bufferChunk = inBuffer.getSubBlock(size_t(size1), size_t(size2));
-        circularChunk.copyFrom(bufferChunk);
+        return mainReader.read(outBuffer, numToRead, numToMark);
     }
 
-    abstractFifo.finishedWrite(numToMark);
+    int start1, size1, start2, size2;
+    abstractFifo.prepareToRead(numToRead, start1, size1, start2, size2);
+    jassert(numToRead == size1+size2);
+
+    read(outBuffer, start1, size1, start2, size2);
+
+    abstractFifo.finishedRead(numToMark);
+    auto sequence = mainReader.sequence.fetch_add(numToMark, std::memory_order_relaxed);
+    return {numToRead, sequence + numToRead, false};
 }
 
-void ASyncBuffer::pop(juce::dsp::AudioBlock<float> outBuffer, int numToRead, int numToMark)
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::readHead(Block outBuffer, int numToRead)
 {
     if(numToRead < 0)
     {
         numToRead = (int)outBuffer.getNumSamples();
     }
-    if(numToMark < 0)
+
+    // the newest samples end where the next one will be written
+    int start1, size1, start2, size2;
+    getSegments(writeSequence.load(std::memory_order_acquire) - numToRead, numToRead, start1, size1, start2, size2);
+    read(outBuffer, start1, size1, start2, size2);
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+typename ASyncBuffer<SampleType, Layout, NumChannels>::ReadView ASyncBuffer<SampleType, Layout, NumChannels>::viewHead(int numToView)
+{
+    jassert(numToView <= capacity);
+
+    // the newest samples end where the next one will be written
+    auto end = writeSequence.load(std::memory_order_acquire);
+    int start = int(((end - numToView) % capacity + capacity) % capacity);
+
+    return ReadView(*this, start, numToView, end);
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+typename ASyncBuffer<SampleType, Layout, NumChannels>::Delta ASyncBuffer<SampleType, Layout, NumChannels>::readSince(juce::int64 sequence, Block outBuffer, int maxToRead)
+{
+    if(maxToRead < 0)
     {
-        numToMark = numToRead;
+        maxToRead = int(outBuffer.getNumSamples());
     }
 
-    auto circBuffer = juce::dsp::AudioBlock<float>(circularBuffer);
-    if(outBuffer.getNumChannels() > circBuffer.getNumChannels())
+    auto end = writeSequence.load(std::memory_order_acquire);
+    auto from = juce::jmax(sequence, getOldestReadable());
+    int numToRead = int(juce::jlimit<juce::int64>(0, juce::int64(maxToRead), end - from));
+
+    int start1, size1, start2, size2;
+    getSegments(from, numToRead, start1, size1, start2, size2);
+    read(outBuffer, start1, size1, start2, size2);
+
+    // the writer can have come round while we were copying, whatever it got to has to go
+    std::atomic_thread_fence(std::memory_order_acquire);
+    int numTorn = int(juce::jlimit<juce::int64>(0, numToRead, writeReach.load(std::memory_order_relaxed) - capacity - from));
+    if(numTorn > 0)
     {
-        outBuffer = outBuffer.getSubsetChannelBlock(0, circBuffer.getNumChannels());
+        for(size_t ch = 0; ch < outBuffer.getNumChannels(); ch++)
+        {
+            auto samplesOut = outBuffer.getChannelPointer(ch);
+            std::copy(samplesOut + numTorn, samplesOut + numToRead, samplesOut);
+        }
+        from += numTorn;
+        numToRead -= numTorn;
     }
-    else if(outBuffer.getNumChannels() < circBuffer.getNumChannels())
+
+    return {numToRead, from + numToRead, from > sequence};
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+typename ASyncBuffer<SampleType, Layout, NumChannels>::Reader ASyncBuffer<SampleType, Layout, NumChannels>::addReader(bool fromNewest)
+{
+    // a new reader either starts with what comes next, or with everything that is still here
+    return Reader(*this, fromNewest ? writeSequence.load(std::memory_order_acquire) : getOldestReadable());
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::trim(int numToTrim)
+{
+    if(canOverwrite)
     {
-        circBuffer = circBuffer.getSubsetChannelBlock(0, outBuffer.getNumChannels());
+        mainReader.skip(numToTrim);
+        return;
     }
 
-    int start1, size1, start2, size2;
-    abstractFifo.prepareToRead(numToRead, start1, size1, start2, size2);
-    jassert(numToRead == size1+size2);
+    abstractFifo.finishedRead(numToTrim);
+    mainReader.sequence.fetch_add(numToTrim, std::memory_order_relaxed);
+}
 
-    if(size1 > 0)
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::trimTo(int numToKeep)
+{
+    if(canOverwrite)
     {
-        auto circularChunk = circBuffer.getSubBlock(size_t(start1), size_t(size1));
-        auto bufferChunk = outBuffer.getSubBlock(0, size_t(size1));
-        bufferChunk.copyFrom(circularChunk);
+        mainReader.skipTo(numToKeep);
+        return;
     }
-    if(size2 > 0)
+
+    trim(juce::jmax(0, abstractFifo.getNumReady() - numToKeep));
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::rewindTo(int numToKeep)
+{
+    // like trimTo, but an overwritable buffer still has what was read, so this can go back as well as forward
+    if(canOverwrite)
     {
-        auto circularChunk = circBuffer.getSubBlock(size_t(start2), size_t(size2));
-        auto bufferChunk = outBuffer.getSubBlock(size_t(size1), size_t(size2));
-        bufferChunk.copyFrom(circularChunk);
+        mainReader.seek(getWriteSequence() - numToKeep);
+        return;
     }
 
-    abstractFifo.finishedRead(numToMark);
+    trimTo(numToKeep);
 }
 
-void ASyncBuffer::readHead(juce::dsp::AudioBlock<float> outBuffer, int numToRead)
+template <typename SampleType, typename Layout, int NumChannels>
+int ASyncBuffer<SampleType, Layout, NumChannels>::getNumUnread() const
 {
-    if(numToRead < 0)
+    if(canOverwrite)
     {
-        numToRead = (int)outBuffer.getNumSamples();
+        return mainReader.getNumUnread();
     }
 
-    auto circBuffer = juce::dsp::AudioBlock<float>(circularBuffer);
-    if(outBuffer.getNumChannels() > circBuffer.getNumChannels())
+    return abstractFifo.getNumReady();
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+int ASyncBuffer<SampleType, Layout, NumChannels>::getSpaceLeft() const
+{
+    // an overwritable buffer never runs out, but this is how much can go in before anything unread is lost
+    return canOverwrite ? capacity - getNumUnread() : abstractFifo.getFreeSpace();
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::reset()
+{
+    for(int region = 0; region < (isInterleaved ? 1 : getNumChannels()); region++)
     {
-        outBuffer = outBuffer.getSubsetChannelBlock(0, circBuffer.getNumChannels());
+        auto start = samples + region * channelSpan;
+        std::fill(start, start + size_t(capacity * (isInterleaved ? getNumChannels() : 1)), SampleType(0));
     }
-    else if(outBuffer.getNumChannels() < circBuffer.getNumChannels())
+    abstractFifo.reset();
+    restartSequence();
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::resize(int newSize)
+{
+    size_t unitBytes = sizeof(SampleType) * size_t(isInterleaved ? getNumChannels() : 1);
+    bool canMirror = wantsMirror && MirroredMemory::isAvailable();
+    if(canMirror)
     {
-        circBuffer = circBuffer.getSubsetChannelBlock(0, outBuffer.getNumChannels());
+        // a mirror has to cover whole pages, so the buffer can come out a little bigger than asked for
+        size_t pageSize = MirroredMemory::getPageSize();
+        size_t step = pageSize / std::gcd(pageSize, unitBytes);
+        newSize = int((size_t(newSize) + step - 1) / step * step);
     }
 
-    int start1, size1, start2, size2;
-    int allReady = abstractFifo.getNumReady();
-    int capacity = abstractFifo.getTotalSize();
-    abstractFifo.prepareToRead(allReady, start1, size1, start2, size2);
-    
-    allReady = abstractFifo.getNumReady();
+    // the same size again keeps the storage where it is, so views taken before are still pointing at something
+    if(samples != nullptr && newSize == capacity && mirrored == canMirror)
+    {
+        reset();
+        return;
+    }
+    jassert(numViews.load() == 0);
+
+    mirrored = canMirror && mirroredData.allocate(size_t(newSize) * unitBytes, isInterleaved ? 1 : getNumChannels());
 
-    if(size2 == 0)
+    if(mirrored)
     {
-        start1 += size1 - numToRead;
-        size1 = numToRead;
+        // fresh pages are already zeroed
+        heapData.free();
+        samples = static_cast<SampleType*>(mirroredData.getData());
+        channelSpan = newSize * 2;
     }
-    else if(numToRead > size2)
+    else
     {
-        size1 = numToRead - size2;
-        start1 = capacity - size1;
+        mirroredData.free();
+        heapData.allocate(size_t(getNumChannels() * newSize), true);
+        samples = heapData.get();
+        channelSpan = newSize;
     }
-    else if(numToRead <= size2)
+
+    abstractFifo.setTotalSize(newSize);
+    capacity = newSize;
+    restartSequence();
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::resize(int newNumChannels, int newSize)
+{
+    jassert(NumChannels == 0 || newNumChannels == NumChannels);
+    if(newNumChannels != numChannels)
     {
-        start1 = 0;
-        size1 = 0;
-        start2 = start2 + size2 - numToRead;
-        size2 = numToRead;
+        capacity = 0; // the storage no longer fits, whatever the size
     }
+    numChannels = newNumChannels;
+    resize(newSize);
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+int ASyncBuffer<SampleType, Layout, NumChannels>::swapContents(ASyncBuffer& other)
+{
+    jassert(other.getNumChannels() == getNumChannels() && other.capacity == capacity);
+    jassert(numViews.load() == 0 && other.numViews.load() == 0);
+
+    // where the next sample would have gone, which is the oldest one once we have wrapped around
+    int next = int(writeSequence.load(std::memory_order_relaxed) % capacity);
+
+    // only the pointers change hands, so this is safe on the audio thread
+    heapData.swapWith(other.heapData);
+    mirroredData.swapWith(other.mirroredData);
+    std::swap(samples, other.samples);
+    std::swap(channelSpan, other.channelSpan);
+    std::swap(mirrored, other.mirrored);
+    abstractFifo.reset();
+    restartSequence();
+
+    return next;
+}
 
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::write(const Block& block, int start1, int size1, int start2, int size2)
+{
+    // with a mirror the second piece carries straight on from the first
+    if(mirrored)
+    {
+        copyIn(block, 0, start1, size1 + size2);
+        return;
+    }
     if(size1 > 0)
     {
-        auto circularChunk = circBuffer.getSubBlock(size_t(start1), size_t(size1));
-        auto bufferChunk = outBuffer.getSubBlock(0, size_t(size1));
-        bufferChunk.copyFrom(circularChunk);
+        copyIn(block, 0, start1, size1);
     }
     if(size2 > 0)
     {
-        auto circularChunk = circBuffer.getSubBlock(size_t(start2), size_t(size2));
-        auto bufferChunk = outBuffer.getSubBlock(size_t(size1), size_t(size2));
-        bufferChunk.copyFrom(circularChunk);
+        copyIn(block, size1, start2, size2);
     }
 }
 
-void ASyncBuffer::trim(int numToTrim)
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::read(Block& block, int start1, int size1, int start2, int size2) const
 {
-    abstractFifo.finishedRead(numToTrim);
+    if(mirrored)
+    {
+        copyOut(block, 0, start1, size1 + size2);
+        return;
+    }
+    if(size1 > 0)
+    {
+        copyOut(block, 0, start1, size1);
+    }
+    if(size2 > 0)
+    {
+        copyOut(block, size1, start2, size2);
+    }
 }
 
-void ASyncBuffer::reset()
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::copyIn(const Block& block, int blockStart, int start, int num)
 {
-    circularBuffer.clear();
-    abstractFifo.reset();
+    // a block with fewer channels than us only fills those, one with more only has its first ones copied
+    int numToCopy = juce::jmin(getNumChannels(), int(block.getNumChannels()));
+
+    if constexpr (isInterleaved)
+    {
+        const SampleType* src[NumChannels] {};
+        for(int ch = 0; ch < numToCopy; ch++)
+        {
+            src[ch] = block.getChannelPointer(size_t(ch)) + blockStart;
+        }
+
+        auto frame = samples + start * NumChannels;
+        for(int i = 0; i < num; i++, frame += NumChannels)
+        {
+            for(int ch = 0; ch < numToCopy; ch++)
+            {
+                frame[ch] = src[ch][i];
+            }
+        }
+    }
+    else
+    {
+        for(int ch = 0; ch < numToCopy; ch++)
+        {
+            copySamples(samples + ch * channelSpan + start, block.getChannelPointer(size_t(ch)) + blockStart, num);
+        }
+    }
 }
 
-void ASyncBuffer::resize(int newSize)
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::copyOut(Block& block, int blockStart, int start, int num) const
 {
-    abstractFifo.setTotalSize(newSize);
-    circularBuffer.setSize(circularBuffer.getNumChannels(), newSize);
+    int numToCopy = juce::jmin(getNumChannels(), int(block.getNumChannels()));
+
+    if constexpr (isInterleaved)
+    {
+        SampleType* dest[NumChannels] {};
+        for(int ch = 0; ch < numToCopy; ch++)
+        {
+            dest[ch] = block.getChannelPointer(size_t(ch)) + blockStart;
+        }
+
+        auto frame = samples + start * NumChannels;
+        for(int i = 0; i < num; i++, frame += NumChannels)
+        {
+            for(int ch = 0; ch < numToCopy; ch++)
+            {
+                dest[ch][i] = frame[ch];
+            }
+        }
+    }
+    else
+    {
+        for(int ch = 0; ch < numToCopy; ch++)
+        {
+            copySamples(block.getChannelPointer(size_t(ch)) + blockStart, samples + ch * channelSpan + start, num);
+        }
+    }
 }
 
-void ASyncBuffer::resize(int numChannels, int newSize)
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::copySamples(SampleType* dest, const SampleType* src, int num)
 {
-    abstractFifo.setTotalSize(newSize);
-    circularBuffer.setSize(numChannels, newSize);
+    if constexpr (std::is_floating_point<SampleType>::value)
+    {
+        juce::FloatVectorOperations::copy(dest, src, num);
+    }
+    else
+    {
+        std::copy(src, src + num, dest);
+    }
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::restartSequence()
+{
+    // the fifo starts again from 0, so the sequence moves on to the next multiple of the capacity
+    // to stay in step with it. readers from before the restart are left with a gap
+    auto next = (writeSequence.load(std::memory_order_relaxed) / capacity + 1) * capacity;
+    oldestSequence.store(next, std::memory_order_relaxed);
+    mainReader.sequence.store(next, std::memory_order_relaxed);
+    writeReach.store(next, std::memory_order_relaxed);
+    writeSequence.store(next, std::memory_order_release);
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+juce::int64 ASyncBuffer<SampleType, Layout, NumChannels>::getOldestReadable() const
+{
+    // anything the writer is about to overwrite, or that went in a reset, is already lost
+    return juce::jmax(oldestSequence.load(std::memory_order_acquire), writeReach.load(std::memory_order_acquire) - capacity);
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::getSegments(juce::int64 from, int num, int& start1, int& size1, int& start2, int& size2) const
+{
+    start1 = int((from % capacity + capacity) % capacity);
+    size1 = juce::jmin(num, capacity - start1);
+    start2 = 0;
+    size2 = num - size1;
+}
+
+//==============================================================================
+template <typename SampleType, typename Layout, int NumChannels>
+ASyncBuffer<SampleType, Layout, NumChannels>::ReadView::ReadView() : owner(nullptr), start(0), numSamples(0), endSequence(0)
+{
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+ASyncBuffer<SampleType, Layout, NumChannels>::ReadView::ReadView(ASyncBuffer& buffer, int firstSample, int numToView, juce::int64 end)
+    : owner(&buffer), start(firstSample), numSamples(numToView), endSequence(end)
+{
+    owner->numViews++;
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+ASyncBuffer<SampleType, Layout, NumChannels>::ReadView::ReadView(ReadView&& other) noexcept
+    : owner(other.owner), start(other.start), numSamples(other.numSamples), endSequence(other.endSequence)
+{
+    other.owner = nullptr;
+    other.numSamples = 0;
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+typename ASyncBuffer<SampleType, Layout, NumChannels>::ReadView& ASyncBuffer<SampleType, Layout, NumChannels>::ReadView::operator=(ReadView&& other) noexcept
+{
+    if(this != &other)
+    {
+        release();
+        owner = other.owner;
+        start = other.start;
+        numSamples = other.numSamples;
+        endSequence = other.endSequence;
+        other.owner = nullptr;
+        other.numSamples = 0;
+    }
+    return *this;
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+ASyncBuffer<SampleType, Layout, NumChannels>::ReadView::~ReadView()
+{
+    release();
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::ReadView::release()
+{
+    if(owner != nullptr)
+    {
+        owner->numViews--;
+        owner = nullptr;
+    }
+    numSamples = 0;
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+int ASyncBuffer<SampleType, Layout, NumChannels>::ReadView::getSegmentSize(int segment) const
+{
+    if(owner == nullptr)
+    {
+        return 0;
+    }
+
+    // with a mirror the samples past the end carry straight on
+    int first = owner->mirrored ? numSamples : juce::jmin(numSamples, owner->capacity - start);
+    return segment == 0 ? first : numSamples - first;
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+const SampleType* ASyncBuffer<SampleType, Layout, NumChannels>::ReadView::getSegment(int channel, int segment) const
+{
+    jassert(owner != nullptr);
+    return owner->getReadPointer(channel) + (segment == 0 ? start : 0) * owner->getSampleStride();
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+bool ASyncBuffer<SampleType, Layout, NumChannels>::ReadView::isIntact() const
+{
+    if(owner == nullptr)
+    {
+        return false;
+    }
+
+    // anything read from the view before this can't have been torn unless the writer had already reached it
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto first = endSequence - numSamples;
+    return owner->oldestSequence.load(std::memory_order_relaxed) <= first &&
+           owner->writeReach.load(std::memory_order_relaxed) - owner->capacity <= first;
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::ReadView::copyTo(Block& block) const
+{
+    if(owner != nullptr)
+    {
+        owner->read(block, start, getSegmentSize(0), 0, getSegmentSize(1));
+    }
+}
+
+//==============================================================================
+template <typename SampleType, typename Layout, int NumChannels>
+ASyncBuffer<SampleType, Layout, NumChannels>::Reader::Reader() : owner(nullptr), sequence(0), numLost(0)
+{
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+ASyncBuffer<SampleType, Layout, NumChannels>::Reader::Reader(ASyncBuffer& buffer, juce::int64 start) : owner(&buffer), sequence(start), numLost(0)
+{
+    owner->numReaders++;
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+ASyncBuffer<SampleType, Layout, NumChannels>::Reader::Reader(Reader&& other) noexcept
+    : owner(other.owner), sequence(other.sequence.load()), numLost(other.numLost.load())
+{
+    other.owner = nullptr;
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+typename ASyncBuffer<SampleType, Layout, NumChannels>::Reader& ASyncBuffer<SampleType, Layout, NumChannels>::Reader::operator=(Reader&& other) noexcept
+{
+    if(this != &other)
+    {
+        release();
+        owner = other.owner;
+        sequence = other.sequence.load();
+        numLost = other.numLost.load();
+        other.owner = nullptr;
+    }
+    return *this;
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+ASyncBuffer<SampleType, Layout, NumChannels>::Reader::~Reader()
+{
+    release();
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::Reader::release()
+{
+    if(owner != nullptr)
+    {
+        owner->numReaders--;
+        owner = nullptr;
+    }
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+typename ASyncBuffer<SampleType, Layout, NumChannels>::Delta ASyncBuffer<SampleType, Layout, NumChannels>::Reader::read(Block outBuffer, int numToRead, int numToMark)
+{
+    jassert(owner != nullptr);
+    if(numToRead < 0)
+    {
+        numToRead = int(outBuffer.getNumSamples());
+    }
+    if(numToMark < 0)
+    {
+        numToMark = numToRead;
+    }
+
+    // if the writer has lapped us we carry on from the oldest sample that is left
+    auto from = sequence.load(std::memory_order_relaxed);
+    auto delta = owner->readSince(from, outBuffer, numToRead);
+    auto first = delta.sequence - delta.numRead;
+    // a reset, resize or swap restarts the sequence further on, but only what was written since then can have been overwritten
+    auto counted = juce::jmax(from, owner->oldestSequence.load(std::memory_order_relaxed));
+    if(delta.gap && first > counted)
+    {
+        numLost.fetch_add(first - counted, std::memory_order_relaxed);
+    }
+    sequence.store(first + juce::jmin(numToMark, delta.numRead), std::memory_order_relaxed);
+    return delta;
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::Reader::skip(int numToSkip)
+{
+    jassert(owner != nullptr);
+    auto from = juce::jmax(sequence.load(std::memory_order_relaxed), owner->getOldestReadable());
+    sequence.store(juce::jmin(from + numToSkip, owner->getWriteSequence()), std::memory_order_relaxed);
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::Reader::skipTo(int numToKeep)
+{
+    // only our sequence moves, however much is dropped
+    jassert(owner != nullptr);
+    sequence.store(juce::jmax(sequence.load(std::memory_order_relaxed), owner->getWriteSequence() - numToKeep), std::memory_order_relaxed);
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+void ASyncBuffer<SampleType, Layout, NumChannels>::Reader::seek(juce::int64 newSequence)
+{
+    // either way, as long as it is still here
+    jassert(owner != nullptr);
+    sequence.store(juce::jlimit(owner->getOldestReadable(), owner->getWriteSequence(), newSequence), std::memory_order_relaxed);
+}
+
+template <typename SampleType, typename Layout, int NumChannels>
+int ASyncBuffer<SampleType, Layout, NumChannels>::Reader::getNumUnread() const
+{
+    if(owner == nullptr)
+    {
+        return 0;
+    }
+
+    auto end = owner->getWriteSequence();
+    return int(juce::jmax(juce::int64(0), end - juce::jmax(sequence.load(std::memory_order_relaxed), owner->getOldestReadable())));
 }
+
+template <typename SampleType, typename Layout, int NumChannels>
+juce::int64 ASyncBuffer<SampleType, Layout, NumChannels>::Reader::getLag() const
+{
+    if(owner == nullptr)
+    {
+        return 0;
+    }
+
+    // anything from before a restart is gone, not late
+    auto from = juce::jmax(sequence.load(std::memory_order_relaxed), owner->oldestSequence.load(std::memory_order_relaxed));
+    return juce::jmax(juce::int64(0), owner->getWriteSequence() - from);
+}
+
+// the buffers the plugin uses, plus double for anything that wants the extra precision.
+// there's no half precision type to build with, so that is left out
+template class ASyncBuffer<float>;
+template class ASyncBuffer<double>;
+template class ASyncBuffer<float, InterleavedLayout, 3>;
+template class ASyncBuffer<juce::int16>;
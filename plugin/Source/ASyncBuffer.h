@@ -11,30 +11,159 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "MirroredMemory.h"
+#include "SampleBuffer.h"
 
+/* how the samples are laid out in memory. planar keeps each channel in its own
+   run, interleaved keeps every channel of a sample together in one frame, so a
+   push or pop walks a single stream however many channels there are */
+struct PlanarLayout {};
+struct InterleavedLayout {};
+
+/* circular buffer between two threads. NumChannels can be fixed at compile time,
+   which interleaved buffers require, or left at 0 and passed to the constructor.
+   a mirrored buffer maps its memory twice so nothing is ever split at the wrap.
+   an overwritable buffer lets the writer carry on over anything unread without touching
+   the read position, the reader finds out what it lost from the sequence numbers */
+template <typename SampleType = float, typename Layout = PlanarLayout, int NumChannels = 0>
 class ASyncBuffer
 {
 public:
+    static_assert(std::is_same<Layout, PlanarLayout>::value || NumChannels > 0, "interleaved buffers need a fixed channel count");
+    static constexpr bool isInterleaved = std::is_same<Layout, InterleavedLayout>::value;
+    static constexpr int fixedNumChannels = NumChannels;
+    // juce's AudioBlock only takes floating point samples, anything else comes in a SampleBlock
+    using Block = std::conditional_t<std::is_floating_point<SampleType>::value, juce::dsp::AudioBlock<SampleType>, SampleBlock<SampleType>>;
+
+    /* the newest samples, read where they lie instead of being copied out. one segment per
+       channel, or two if they wrap and the buffer isn't mirrored. a view pins the storage until
+       it is dropped, and can tell once the writer has come round and overwritten it */
+    class ReadView
+    {
+    public:
+        ReadView();
+        ReadView(ReadView&& other) noexcept;
+        ReadView& operator=(ReadView&& other) noexcept;
+        ~ReadView();
+
+        inline int getNumSamples() const {return numSamples;}
+        inline juce::int64 getEndSequence() const {return endSequence;} // the sequence number just past the newest sample
+        inline bool isContiguous() const {return getSegmentSize(1) == 0;}
+        int getSegmentSize(int segment) const;
+        const SampleType* getSegment(int channel, int segment) const;
+        bool isIntact() const;
+        void copyTo(Block& block) const;
+
+    private:
+        friend class ASyncBuffer;
+        ReadView(ASyncBuffer& buffer, int firstSample, int numToView, juce::int64 end);
+        void release();
+
+        ASyncBuffer* owner;
+        int start, numSamples;
+        juce::int64 endSequence;
+        //==============================================================================
+        JUCE_DECLARE_NON_COPYABLE (ReadView)
+    };
+
+    /* what readSince got: how many samples, the sequence to ask from next time, and
+       whether some were overwritten before we could read them */
+    struct Delta
+    {
+        int numRead;
+        juce::int64 sequence;
+        bool gap;
+    };
+
+    /* a cursor of its own into everything that is written, so any number of consumers can
+       follow the same stream. the writer never waits for a reader, one that falls behind
+       loses the oldest samples and keeps count of them. pop, trim and trimTo use the
+       buffer's own reader */
+    class Reader
+    {
+    public:
+        Reader();
+        Reader(Reader&& other) noexcept;
+        Reader& operator=(Reader&& other) noexcept;
+        ~Reader();
+
+        Delta read(Block outBuffer, int numToRead = -1, int numToMark = -1);
+        void skip(int numToSkip);
+        void skipTo(int numToKeep);
+        void seek(juce::int64 newSequence);
+        int getNumUnread() const;
+        juce::int64 getLag() const; // how far behind the writer we are, counting anything lost since the last restart
+        inline juce::int64 getNumLost() const {return numLost.load(std::memory_order_relaxed);}
+        inline juce::int64 getSequence() const {return sequence.load(std::memory_order_relaxed);}
+        inline bool isAttached() const {return owner != nullptr;}
+
+    private:
+        friend class ASyncBuffer;
+        Reader(ASyncBuffer& buffer, juce::int64 start);
+        void release();
+
+        ASyncBuffer* owner;
+        std::atomic<juce::int64> sequence; // the next sample we will read, only ever moved by our own thread
+        std::atomic<juce::int64> numLost; // overwritten before we got to them, readable from anywhere. a reset or resize isn't a loss
+        //==============================================================================
+        JUCE_DECLARE_NON_COPYABLE (Reader)
+    };
+
     ASyncBuffer(int numChannels, int size);
     ~ASyncBuffer();
 
-    void push(juce::dsp::AudioBlock<float> inBuffer, int numToWrite = -1, int numToMark = -1);
-    void pop(juce::dsp::AudioBlock<float> outBuffer, int numToRead = -1, int numToMark = -1);
-    void readHead(juce::dsp::AudioBlock<float> outBuffer, int numToRead = -1);
+    void push(Block inBuffer, int numToWrite = -1, int numToMark = -1);
+    Delta pop(Block outBuffer, int numToRead = -1, int numToMark = -1);
+    void readHead(Block outBuffer, int numToRead = -1);
+    ReadView viewHead(int numToView);
+    Delta readSince(juce::int64 sequence, Block outBuffer, int maxToRead = -1);
+    Reader addReader(bool fromNewest = true);
     void trim(int numToTrim);
+    void trimTo(int numToKeep);
+    void rewindTo(int numToKeep);
     void reset();
     void resize(int newSize);
     void resize(int numChannels, int newSize);
-    inline int getNumUnread()   {return abstractFifo.getNumReady();}
-    inline int getNumChannels() {return circularBuffer.getNumChannels();}
-    inline int getSpaceLeft()   {return abstractFifo.getFreeSpace();}
-    inline int getTotalSize()   {return abstractFifo.getTotalSize();}
-    inline void setIsOverwritable(bool overwrite) {canOverwrite = overwrite;}
+    int swapContents(ASyncBuffer& other);
+    int getNumUnread() const;
+    int getSpaceLeft() const;
+    inline int getNumChannels() const {return NumChannels > 0 ? NumChannels : numChannels;}
+    inline int getNumReaders() const  {return numReaders.load();} // counting our own
+    inline int getTotalSize() const   {return abstractFifo.getTotalSize();}
+    inline juce::int64 getWriteSequence() const {return writeSequence.load(std::memory_order_acquire);}
+    inline void setIsOverwritable(bool overwrite) {canOverwrite = overwrite;} // set it before the buffer is used
+    inline void setIsMirrored(bool mirror) {wantsMirror = mirror;} // takes effect at the next resize
+    inline bool isMirrored() const {return mirrored;}
+    /* raw access, for reading a buffer nobody is writing to */
+    inline const SampleType* getReadPointer(int channel) const {return samples + (isInterleaved ? channel : channel * channelSpan);}
+    inline int getSampleStride() const {return isInterleaved ? getNumChannels() : 1;}
 
 private:
+    void write(const Block& block, int start1, int size1, int start2, int size2);
+    void read(Block& block, int start1, int size1, int start2, int size2) const;
+    void copyIn(const Block& block, int blockStart, int start, int num);
+    void copyOut(Block& block, int blockStart, int start, int num) const;
+    static void copySamples(SampleType* dest, const SampleType* src, int num);
+    void restartSequence();
+    juce::int64 getOldestReadable() const;
+    void getSegments(juce::int64 from, int num, int& start1, int& size1, int& start2, int& size2) const;
+
     juce::AbstractFifo abstractFifo;
-    juce::AudioBuffer<float> circularBuffer;
+    juce::HeapBlock<SampleType> heapData; // capacity samples per channel, laid out as Layout says
+    MirroredMemory mirroredData; // the same, but each channel (or the frames) followed by its mirror
+    SampleType* samples; // whichever of the two we are using
+    int numChannels, capacity;
+    int channelSpan; // distance between planar channels, twice the capacity when mirrored
     bool canOverwrite = false;
+    bool wantsMirror = false;
+    bool mirrored = false;
+    /* every sample written gets the next sequence number, and sample n is always at n % capacity */
+    std::atomic<juce::int64> writeSequence {0}; // one past the newest sample, moved on once it is in
+    std::atomic<juce::int64> writeReach {0}; // one past the furthest sample being written, moved on before it goes in
+    std::atomic<juce::int64> oldestSequence {0}; // nothing before this is left since the last reset
+    std::atomic<int> numReaders {0};
+    Reader mainReader; // what pop reads from
+    std::atomic<int> numViews {0}; // views still pinning the storage
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ASyncBuffer)
 };
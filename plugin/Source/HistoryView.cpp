@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    HistoryView.cpp
+    Created: 19 Oct 2026 9:03:52pm
+    Author:  Michael Nuzzo
+
+  ==============================================================================
+*/
+
+#include "HistoryView.h"
+
+HistoryView::HistoryView(int tracesPerColumn) : numTraces(tracesPerColumn), numSamples(0), viewStart(0), viewLength(1), mapper(tracesPerColumn)
+{
+}
+
+HistoryView::~HistoryView()
+{
+}
+
+void HistoryView::prepare(int maxPixels)
+{
+    columns.setSize(numTraces * 3, maxPixels);
+    mapper.prepare(maxPixels);
+}
+
+void HistoryView::reset(int newNumSamples, double visibleSamples)
+{
+    // start on the newest part of the history, which is what was on screen when we froze
+    numSamples = newNumSamples;
+    viewLength = juce::jlimit(MIN_VISIBLE_SAMPLES, juce::jmax(MIN_VISIBLE_SAMPLES, double(numSamples)), visibleSamples);
+    viewStart = numSamples - viewLength;
+}
+
+void HistoryView::pan(double fraction)
+{
+    viewStart = juce::jlimit(juce::jmin(0.0, numSamples - viewLength), juce::jmax(0.0, numSamples - viewLength), viewStart + fraction * viewLength);
+}
+
+void HistoryView::zoom(double factor, double anchor)
+{
+    // keep the sample under the mouse where it is
+    double anchorSample = viewStart + anchor * viewLength;
+    viewLength = juce::jlimit(MIN_VISIBLE_SAMPLES, juce::jmax(MIN_VISIBLE_SAMPLES, double(numSamples)), viewLength * factor);
+    viewStart = anchorSample - anchor * viewLength;
+    pan(0);
+}
+
+void HistoryView::render(const float* const* history, int stride, int size, int oldest, SampleBuffer<juce::int16>& spans, int numPixels)
+{
+    jassert(numPixels <= columns.getNumSamples());
+
+    decimate(history, stride, size, oldest, numPixels);
+
+    // every render is a whole new window, so nothing should join onto the last one
+    mapper.reset();
+    mapper.push(columns, numPixels, spans);
+}
+
+void HistoryView::decimate(const float* const* history, int stride, int size, int oldest, int numPixels)
+{
+    for(int ch = 0; ch < columns.getNumChannels(); ch++)
+    {
+        juce::FloatVectorOperations::fill(columns.getWritePointer(ch), NAN, numPixels);
+    }
+
+    double samplesPerPixel = viewLength / numPixels;
+
+    for(int x = 0; x < numPixels; x++)
+    {
+        double position = viewStart + x * samplesPerPixel;
+
+        // zoomed out, each column gets the min and max of its samples like the live display
+        if(samplesPerPixel >= 1)
+        {
+            int start = juce::jmax(0, int(position));
+            int end = juce::jmin(numSamples, int(position + samplesPerPixel));
+            if(start < end)
+            {
+                findMinAndMax(history, stride, size, oldest, start, end, x);
+            }
+        }
+        // zoomed in, we interpolate between the two samples either side
+        else if(position >= 0 && position < numSamples - 1)
+        {
+            int i = int(position);
+            float frac = float(position - i);
+            for(int t = 0; t < numTraces; t++)
+            {
+                float v0 = history[t][((oldest + i) % size) * stride];
+                float v1 = history[t][((oldest + i + 1) % size) * stride];
+                columns.setSample(t, x, v0 + (v1 - v0) * frac);
+            }
+        }
+    }
+}
+
+void HistoryView::findMinAndMax(const float* const* history, int stride, int size, int oldest, int start, int end, int column)
+{
+    // the history is circular, so the samples can come in two pieces
+    int first = (oldest + start) % size;
+    int size1 = juce::jmin(end - start, size - first);
+    int size2 = end - start - size1;
+
+    for(int t = 0; t < numTraces; t++)
+    {
+        // the samples of one trace can be interleaved with the others
+        auto data = history[t];
+        float lowest = data[first * stride];
+        float highest = lowest;
+        auto scan = [&](int from, int num)
+        {
+            for(int i = from; i < from + num; i++)
+            {
+                lowest = juce::jmin(lowest, data[i * stride]);
+                highest = juce::jmax(highest, data[i * stride]);
+            }
+        };
+        scan(first, size1);
+        scan(0, size2);
+
+        columns.setSample(t, column, lowest);
+        columns.setSample(numTraces + t, column, highest);
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ ==============================================================================
+
+ HistoryView.h
+ Created: 19 Oct 2026 9:03:52pm
+ Author:  Michael Nuzzo
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpanMapper.h"
+
+/* a pannable, zoomable window onto the raw history the processor hands over
+   when the display is frozen. the visible part is decimated on demand, so it
+   can be drawn at any zoom without the audio thread doing anything */
+class HistoryView
+{
+public:
+    HistoryView(int tracesPerColumn);
+    ~HistoryView();
+
+    void prepare(int maxPixels);
+    void reset(int newNumSamples, double visibleSamples);
+    void pan(double fraction);
+    void zoom(double factor, double anchor);
+    void render(const float* const* history, int stride, int size, int oldest, SampleBuffer<juce::int16>& spans, int numPixels);
+    inline SpanMapper& getMapper() {return mapper;}
+    inline double getStart() {return viewStart;}
+    inline double getLength() {return viewLength;}
+    inline int getNumSamples() {return numSamples;}
+
+    static constexpr double MIN_VISIBLE_SAMPLES = 16.0; // how far in we let you zoom
+
+private:
+    void decimate(const float* const* history, int stride, int size, int oldest, int numPixels);
+    void findMinAndMax(const float* const* history, int stride, int size, int oldest, int start, int end, int column);
+
+    const int numTraces;
+    int numSamples; // length of the history, oldest sample first
+    double viewStart, viewLength; // the part of the history in the window, in samples
+    juce::AudioBuffer<float> columns; // value, min and max-hold per trace, laid out like the processor's sweeps
+    SpanMapper mapper;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HistoryView)
+};
@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    LTTBDecimator.cpp
+    Created: 19 Oct 2026 3:47:31pm
+    Author:  Michael Nuzzo
+
+  ==============================================================================
+*/
+
+#include "LTTBDecimator.h"
+
+LTTBDecimator::LTTBDecimator(int numChannels) : pendingSize(0)
+{
+    pending.setSize(numChannels, 1);
+    selectedX.malloc(size_t(numChannels));
+    selectedY.malloc(size_t(numChannels));
+    reset();
+}
+
+LTTBDecimator::~LTTBDecimator()
+{
+}
+
+void LTTBDecimator::prepare(int maxBucketSize)
+{
+    pending.setSize(pending.getNumChannels(), maxBucketSize, false, false, true);
+    reset();
+}
+
+void LTTBDecimator::reset()
+{
+    for(int ch = 0; ch < pending.getNumChannels(); ch++)
+    {
+        selectedX[ch] = 0.f;
+        selectedY[ch] = NAN;
+    }
+    pendingSize = 0;
+}
+
+void LTTBDecimator::process(const juce::dsp::AudioBlock<float>& bucket, juce::dsp::AudioBlock<float>& outBlock, int firstChannel)
+{
+    jassert(firstChannel + int(bucket.getNumChannels()) <= pending.getNumChannels());
+    int numNext = juce::jmin(int(bucket.getNumSamples()), pending.getNumSamples());
+
+    // the bucket can be a subset of our channels, starting at firstChannel
+    for(int c = 0; c < int(bucket.getNumChannels()); c++)
+    {
+        int ch = firstChannel + c;
+        auto next = bucket.getChannelPointer(size_t(c));
+
+        // the average of the lookahead bucket is the third corner of the triangle
+        float sum = 0.f;
+        int count = 0;
+        for(int i = 0; i < numNext; i++)
+        {
+            if(std::isfinite(next[i]))
+            {
+                sum += next[i];
+                count++;
+            }
+        }
+        float xc = float(pendingSize) + float(numNext - 1) / 2.f;
+        float yc = count > 0 ? sum / float(count) : NAN;
+
+        float result = NAN;
+        if(pendingSize > 0)
+        {
+            auto prev = pending.getReadPointer(ch);
+            float xa = selectedX[ch];
+            float ya = selectedY[ch];
+
+            // pick the point that makes the biggest triangle with the last pick and the lookahead average
+            int best = 0;
+            float bestArea = -1.f;
+            for(int i = 0; i < pendingSize; i++)
+            {
+                float area = std::abs((xa - xc) * (prev[i] - ya) - (xa - float(i)) * (yc - ya));
+                if(area > bestArea)
+                {
+                    bestArea = area;
+                    best = i;
+                }
+            }
+
+            result = prev[best];
+            selectedX[ch] = float(best - pendingSize);
+            selectedY[ch] = result;
+        }
+
+        outBlock.setSample(c, 0, result);
+        juce::FloatVectorOperations::copy(pending.getWritePointer(ch), next, numNext);
+    }
+
+    pendingSize = numNext;
+}
@@ -0,0 +1,36 @@
+/*
+ ==============================================================================
+
+ LTTBDecimator.h
+ Created: 19 Oct 2026 3:47:31pm
+ Author:  Michael Nuzzo
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/* Largest-Triangle-Three-Buckets, run one pixel bucket at a time.
+   Each call hands in the next bucket, which is only used as lookahead to
+   pick the point from the bucket before it, so the output lags by a pixel. */
+class LTTBDecimator
+{
+public:
+    LTTBDecimator(int numChannels);
+    ~LTTBDecimator();
+
+    void prepare(int maxBucketSize);
+    void reset();
+    void process(const juce::dsp::AudioBlock<float>& bucket, juce::dsp::AudioBlock<float>& outBlock, int firstChannel = 0);
+
+private:
+    juce::AudioBuffer<float> pending; // the bucket we still have to pick a point from
+    juce::HeapBlock<float> selectedX; // last picked point, relative to the start of the pending bucket
+    juce::HeapBlock<float> selectedY;
+    int pendingSize;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LTTBDecimator)
+};
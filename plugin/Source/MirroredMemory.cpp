@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    MirroredMemory.cpp
+    Created: 19 Oct 2026 11:02:18pm
+    Author:  Michael Nuzzo
+
+  ==============================================================================
+*/
+
+#include "MirroredMemory.h"
+
+#if JUCE_LINUX
+ #include <sys/mman.h>
+ #include <unistd.h>
+#endif
+
+MirroredMemory::MirroredMemory() : data(nullptr), mappedBytes(0)
+{
+}
+
+MirroredMemory::~MirroredMemory()
+{
+    free();
+}
+
+bool MirroredMemory::allocate(size_t regionBytes, int numRegions)
+{
+    free();
+
+#if JUCE_LINUX
+    // the mirror has to start on a page boundary
+    jassert(regionBytes > 0 && regionBytes % getPageSize() == 0);
+    size_t fileBytes = regionBytes * size_t(numRegions);
+
+    int fd = memfd_create("ASyncBuffer", MFD_CLOEXEC);
+    if(fd < 0)
+    {
+        return false;
+    }
+    if(ftruncate(fd, off_t(fileBytes)) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    // reserve the whole range first, so nothing else can be mapped in between the copies
+    void* base = mmap(nullptr, fileBytes * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(base == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+
+    bool mapped = true;
+    for(int region = 0; region < numRegions && mapped; region++)
+    {
+        for(int copy = 0; copy < 2 && mapped; copy++)
+        {
+            auto address = static_cast<char*>(base) + (size_t(region) * 2 + size_t(copy)) * regionBytes;
+            mapped = mmap(address, regionBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, off_t(size_t(region) * regionBytes)) == address;
+        }
+    }
+
+    // the mappings keep the memory alive without the file
+    close(fd);
+
+    if(!mapped)
+    {
+        munmap(base, fileBytes * 2);
+        return false;
+    }
+
+    data = base;
+    mappedBytes = fileBytes * 2;
+    return true;
+#else
+    juce::ignoreUnused(regionBytes, numRegions);
+    return false;
+#endif
+}
+
+void MirroredMemory::free()
+{
+#if JUCE_LINUX
+    if(data != nullptr)
+    {
+        munmap(data, mappedBytes);
+    }
+#endif
+    data = nullptr;
+    mappedBytes = 0;
+}
+
+void MirroredMemory::swapWith(MirroredMemory& other) noexcept
+{
+    std::swap(data, other.data);
+    std::swap(mappedBytes, other.mappedBytes);
+}
+
+size_t MirroredMemory::getPageSize()
+{
+#if JUCE_LINUX
+    return size_t(sysconf(_SC_PAGESIZE));
+#else
+    return 4096;
+#endif
+}
+
+bool MirroredMemory::isAvailable()
+{
+#if JUCE_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
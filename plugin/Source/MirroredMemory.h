@@ -0,0 +1,39 @@
+/*
+ ==============================================================================
+
+ MirroredMemory.h
+ Created: 19 Oct 2026 11:02:18pm
+ Author:  Michael Nuzzo
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/* memory where each region is mapped twice, back to back, so reading or writing
+   past the end of a region carries on at its start. a ring buffer built on it
+   never has to split a copy at the wrap. only available on Linux for now */
+class MirroredMemory
+{
+public:
+    MirroredMemory();
+    ~MirroredMemory();
+
+    bool allocate(size_t regionBytes, int numRegions);
+    void free();
+    void swapWith(MirroredMemory& other) noexcept;
+    inline void* getData() const {return data;}
+    inline bool isAllocated() const {return data != nullptr;}
+
+    static size_t getPageSize();
+    static bool isAvailable();
+
+private:
+    void* data; // first copy of the first region, each region is followed by its mirror
+    size_t mappedBytes;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MirroredMemory)
+};
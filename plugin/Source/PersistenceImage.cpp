@@ -0,0 +1,216 @@
+/*
+  ==============================================================================
+
+    PersistenceImage.cpp
+    Created: 19 Oct 2026 1:22:48pm
+    Author:  Michael Nuzzo
+
+  ==============================================================================
+*/
+
+#include "PersistenceImage.h"
+
+PersistenceImage::PersistenceImage() : width(0), height(0), numTraces(0), fullScale(64.f), peak(0), addedSinceDecay(false)
+{
+}
+
+PersistenceImage::~PersistenceImage()
+{
+}
+
+bool PersistenceImage::prepare(int newWidth, int newHeight, int newNumTraces)
+{
+    if(newWidth == width && newHeight == height && newNumTraces == numTraces)
+    {
+        return false;
+    }
+
+    width = newWidth;
+    height = newHeight;
+    numTraces = newNumTraces;
+
+    accumulation.malloc(size_t(numTraces * width * height));
+    hasContent.malloc(size_t(numTraces));
+    colourMap.malloc(size_t(numTraces * 256));
+
+    for(int t = 0; t < numTraces; t++)
+    {
+        setColour(t, juce::Colours::white);
+    }
+    clear();
+
+    return true;
+}
+
+void PersistenceImage::setColour(int trace, juce::Colour c)
+{
+    for(int level = 0; level < 256; level++)
+    {
+        // square root so a single hit is still clearly visible
+        float brightness = std::sqrt(float(level) / 255.f);
+        colourMap[trace * 256 + level] = juce::PixelARGB(255,
+                                                         juce::uint8(c.getRed()   * brightness),
+                                                         juce::uint8(c.getGreen() * brightness),
+                                                         juce::uint8(c.getBlue()  * brightness));
+    }
+}
+
+void PersistenceImage::clear()
+{
+    juce::FloatVectorOperations::clear(accumulation.get(), numTraces * width * height);
+    for(int t = 0; t < numTraces; t++)
+    {
+        hasContent[t] = false;
+    }
+    peak = 0;
+    addedSinceDecay = false;
+}
+
+void PersistenceImage::decay(float factor)
+{
+    // untouched pixels head towards denormals after a minute or so
+    juce::ScopedNoDenormals noDenormals;
+
+    for(int t = 0; t < numTraces; t++)
+    {
+        if(hasContent[t])
+        {
+            juce::FloatVectorOperations::multiply(accumulation.get() + t * width * height, factor, width * height);
+        }
+    }
+
+    // one hit per frame adds up to 1 + factor + factor^2 + ... = 1 / (1 - factor)
+    if(factor < 1.f)
+    {
+        fullScale = juce::jmax(1.f, 1.f / (1.f - factor));
+    }
+
+    // once everything has faded below the first level there is nothing left to decay
+    peak = (peak + (addedSinceDecay.exchange(false) ? 1.f : 0.f)) * factor;
+    if(peak < getThreshold())
+    {
+        clear();
+    }
+}
+
+void PersistenceImage::scroll(int numColumns)
+{
+    if(numColumns <= 0)
+    {
+        return;
+    }
+    if(numColumns >= width)
+    {
+        clear();
+        return;
+    }
+
+    // the accumulation moves along with the trace, the columns that open up on the right start empty
+    int numKept = width - numColumns;
+    for(int t = 0; t < numTraces; t++)
+    {
+        if(!hasContent[t])
+        {
+            continue;
+        }
+        for(int y = 0; y < height; y++)
+        {
+            auto line = accumulation.get() + t * width * height + y * width;
+            std::memmove(line, line + numColumns, size_t(numKept) * sizeof(float));
+            juce::FloatVectorOperations::clear(line + numKept, numColumns);
+        }
+    }
+}
+
+void PersistenceImage::addSpan(int trace, int x, int yTop, int yBottom)
+{
+    if(!juce::isPositiveAndBelow(x, width))
+    {
+        return;
+    }
+
+    yTop = juce::jlimit(0, height - 1, yTop);
+    yBottom = juce::jlimit(0, height - 1, yBottom);
+
+    auto column = accumulation.get() + trace * width * height + x;
+    for(int y = yTop; y <= yBottom; y++)
+    {
+        column[y * width] += 1.f;
+    }
+    hasContent[trace] = true;
+    addedSinceDecay = true;
+}
+
+void PersistenceImage::render(juce::Image& target, int startColumn, int endColumn)
+{
+    jassert(target.getWidth() >= width && target.getHeight() >= height);
+    startColumn = juce::jmax(0, startColumn);
+    endColumn = juce::jmin(width, endColumn);
+
+    const float* traces[8];
+    const juce::PixelARGB* maps[8];
+    int numActive = 0;
+    for(int t = 0; t < numTraces && numActive < 8; t++)
+    {
+        if(hasContent[t])
+        {
+            traces[numActive] = accumulation.get() + t * width * height;
+            maps[numActive] = colourMap.get() + t * 256;
+            numActive++;
+        }
+    }
+
+    // log scale so a single hit stays visible while the pixels the trace sits on every frame reach full brightness,
+    // anything below the first level is skipped without taking the log
+    const float scale = 255.f / std::log1p(fullScale);
+    const float threshold = getThreshold();
+
+    juce::Image::BitmapData pixels(target, juce::Image::BitmapData::writeOnly);
+
+    for(int y = 0; y < height; y++)
+    {
+        auto line = pixels.getLinePointer(y);
+        int offset = y * width;
+
+        for(int x = startColumn; x < endColumn; x++)
+        {
+            // the traces are added together so overlapping ones mix
+            int r = 0, g = 0, b = 0;
+            for(int t = 0; t < numActive; t++)
+            {
+                float value = traces[t][offset + x];
+                if(value < threshold)
+                {
+                    continue;
+                }
+                int level = juce::jmin(255, int(std::log1p(value) * scale));
+                const auto& c = maps[t][level];
+                r += c.getRed();
+                g += c.getGreen();
+                b += c.getBlue();
+            }
+
+            reinterpret_cast<juce::PixelARGB*>(line + x * pixels.pixelStride)->setARGB(255,
+                                                                                       juce::uint8(juce::jmin(255, r)),
+                                                                                       juce::uint8(juce::jmin(255, g)),
+                                                                                       juce::uint8(juce::jmin(255, b)));
+        }
+    }
+}
+
+bool PersistenceImage::hasAnyContent() const
+{
+    for(int t = 0; t < numTraces; t++)
+    {
+        if(hasContent[t])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+float PersistenceImage::getThreshold() const
+{
+    return std::expm1(std::log1p(fullScale) / 255.f);
+}
@@ -0,0 +1,43 @@
+/*
+ ==============================================================================
+
+ PersistenceImage.h
+ Created: 19 Oct 2026 1:22:48pm
+ Author:  Michael Nuzzo
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class PersistenceImage
+{
+public:
+    PersistenceImage();
+    ~PersistenceImage();
+
+    bool prepare(int newWidth, int newHeight, int newNumTraces);
+    void setColour(int trace, juce::Colour c);
+    void clear();
+    void decay(float factor);
+    void scroll(int numColumns);
+    void addSpan(int trace, int x, int yTop, int yBottom);
+    void render(juce::Image& target, int startColumn, int endColumn);
+    bool hasAnyContent() const; // is anything still bright enough to show?
+
+private:
+    int width, height, numTraces;
+    float fullScale; // accumulation a pixel hit every frame settles at, mapped to full brightness
+    float peak; // no pixel is brighter than this, a pixel gains at most one hit per frame
+    std::atomic<bool> addedSinceDecay; // has anything been drawn since the last decay?
+    juce::HeapBlock<float> accumulation; // one float per pixel per trace, 1.0 per hit
+    juce::HeapBlock<std::atomic<bool>> hasContent; // traces we have drawn into since the last clear, set from whichever tile draws first
+    juce::HeapBlock<juce::PixelARGB> colourMap; // 256 intensity levels per trace
+
+    float getThreshold() const; // the faintest accumulation that still gets a colour
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PersistenceImage)
+};
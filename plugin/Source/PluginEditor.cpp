@@ -11,33 +11,26 @@
 
 //==============================================================================
 CompressOScopeAudioProcessorEditor::CompressOScopeAudioProcessorEditor (CompressOScopeAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p), lastSequence(-1), displayReader(p.displayCollector.addReader()), copyInStep(false), frameCost(0), lastPersistenceTime(0), persistenceCompMode(false), displayScale(1.f)
+    , history(p.NUM_CH + 1), lastSnapshot(-1), lastDragX(0)
 {
     //==========================================================================================//
 
     /* initialize */
 
-    setSize (1000, 800);
-    startTimerHz(60);
+    // repaints are handed out by the shared scheduler, and only when there is something new
+    scheduler->addClient(this);
+    history.prepare(audioProcessor.MAX_NUM_PIXELS);
+    for(auto* param : audioProcessor.AudioProcessor::getParameters())
+    {
+        param->addListener(this);
+    }
 
     f = juce::Font("Gill Sans", "Regular", 15.f);
     float rescale = 1/8.f;
     logo = juce::ImageCache::getFromMemory (BinaryData::logo_light_png, BinaryData::logo_light_pngSize);
     logo = logo.rescaled(int(logo.getWidth()*rescale), int(logo.getHeight()*rescale));
 
-    // oscilloscope window
-    int padding = 50;
-    window.setSize(getWidth()-padding, getHeight()*1/2);
-    window.setLeft(padding*3);
-    window.setTop(padding);
-
-    // initialize display buffer
-    displayBuffer.setSize(audioProcessor.displayCollector.getNumChannels(), window.getWidth());
-    displayBuffer.clear();
-
-    // talk to audio thread
-    audioProcessor.setNumPixels(window.getWidth());
-
     // set global colour preferences
     getLookAndFeel().setColour(juce::ToggleButton::ColourIds::textColourId, juce::Colours::lightgrey);
     getLookAndFeel().setColour(juce::ToggleButton::ColourIds::tickColourId, juce::Colours::lightgrey);
@@ -54,7 +47,7 @@ CompressOScopeAudioProcessorEditor::CompressOScopeAudioProcessorEditor (Compress
     timeKnob.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
     timeKnob.setTextBoxStyle(juce::Slider::TextEntryBoxPosition::TextBoxBelow, false, 100, 20);
     timeKnob.setTextValueSuffix(" s");
-    timeKnob.onValueChange = [this] {audioProcessor.setNumPixels(window.getWidth()); audioProcessor.setUpdate();};
+    timeKnob.onValueChange = [this] {audioProcessor.setNumPixels(displayBuffer.getNumSamples()); audioProcessor.setUpdate();};
     timeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.getParameters(),"TIME",timeKnob);
     timeLabel.setText("Time Axis", juce::dontSendNotification);
     timeLabel.setJustificationType(juce::Justification::horizontallyCentred);
@@ -167,10 +160,135 @@ CompressOScopeAudioProcessorEditor::CompressOScopeAudioProcessorEditor (Compress
     smoothingLabel.attachToComponent(&smoothingButton, true);
     addAndMakeVisible(smoothingButton);
 
+    // trigger checkbox
+    triggerButton.onStateChange = [this] {
+        auto triggerMode = triggerButton.getToggleStateValue().getValue();
+        triggerLevelKnob.setEnabled(triggerMode);
+        triggerGainLevelKnob.setEnabled(triggerMode);
+        triggerHoldoffKnob.setEnabled(triggerMode);
+        triggerSlopeBox.setEnabled(triggerMode);
+        triggerChannelBox.setEnabled(triggerMode);
+        averageKnob.setEnabled(triggerMode);
+        maxHoldButton.setEnabled(triggerMode);
+        audioProcessor.setUpdate();
+    };
+    triggerAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.getParameters(),"TRIGGER",triggerButton);
+    triggerLabel.setText("Trigger", juce::dontSendNotification);
+    triggerLabel.setJustificationType(juce::Justification::horizontallyCentred);
+    triggerLabel.attachToComponent(&triggerButton, true);
+    addAndMakeVisible(triggerButton);
+
+    // trigger level slider
+    triggerLevelKnob.setColour(juce::Slider::ColourIds::thumbColourId, juce::Colours::lightgrey);
+    triggerLevelKnob.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
+    triggerLevelKnob.setTextBoxStyle(juce::Slider::TextEntryBoxPosition::TextBoxBelow, false, 100, 20);
+    triggerLevelKnob.onValueChange = [this] {audioProcessor.setUpdate();};
+    triggerLevelAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.getParameters(),"TRIGLEVEL",triggerLevelKnob);
+    triggerLevelLabel.setText("Trigger Level", juce::dontSendNotification);
+    triggerLevelLabel.setJustificationType(juce::Justification::horizontallyCentred);
+    triggerLevelLabel.attachToComponent(&triggerLevelKnob, true);
+    addAndMakeVisible(triggerLevelKnob);
+
+    // the gain channel has its own level in dB, shown in place of the one above when it is the source
+    triggerGainLevelKnob.setColour(juce::Slider::ColourIds::thumbColourId, juce::Colours::lightgrey);
+    triggerGainLevelKnob.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
+    triggerGainLevelKnob.setTextBoxStyle(juce::Slider::TextEntryBoxPosition::TextBoxBelow, false, 100, 20);
+    triggerGainLevelKnob.setTextValueSuffix(" dB");
+    triggerGainLevelKnob.onValueChange = [this] {audioProcessor.setUpdate();};
+    triggerGainLevelAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.getParameters(),"TRIGGAINLEVEL",triggerGainLevelKnob);
+    triggerGainLevelLabel.setText("Trigger Level", juce::dontSendNotification);
+    triggerGainLevelLabel.setJustificationType(juce::Justification::horizontallyCentred);
+    triggerGainLevelLabel.attachToComponent(&triggerGainLevelKnob, true);
+    addAndMakeVisible(triggerGainLevelKnob);
+
+    // trigger holdoff slider
+    triggerHoldoffKnob.setColour(juce::Slider::ColourIds::thumbColourId, juce::Colours::lightgrey);
+    triggerHoldoffKnob.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
+    triggerHoldoffKnob.setTextBoxStyle(juce::Slider::TextEntryBoxPosition::TextBoxBelow, false, 100, 20);
+    triggerHoldoffKnob.setTextValueSuffix(" ms");
+    triggerHoldoffKnob.onValueChange = [this] {audioProcessor.setUpdate();};
+    triggerHoldoffAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.getParameters(),"TRIGHOLDOFF",triggerHoldoffKnob);
+    triggerHoldoffLabel.setText("Trigger Holdoff", juce::dontSendNotification);
+    triggerHoldoffLabel.setJustificationType(juce::Justification::horizontallyCentred);
+    triggerHoldoffLabel.attachToComponent(&triggerHoldoffKnob, true);
+    addAndMakeVisible(triggerHoldoffKnob);
+
+    // trigger slope and channel selectors
+    triggerSlopeBox.addItemList({"Rising", "Falling"}, 1);
+    triggerSlopeBox.onChange = [this] {audioProcessor.setUpdate();};
+    triggerSlopeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.getParameters(),"TRIGSLOPE",triggerSlopeBox);
+    triggerSlopeLabel.setText("Slope", juce::dontSendNotification);
+    triggerSlopeLabel.setJustificationType(juce::Justification::horizontallyCentred);
+    triggerSlopeLabel.attachToComponent(&triggerSlopeBox, true);
+    addAndMakeVisible(triggerSlopeBox);
+
+    triggerChannelBox.addItemList({"Input", "Output", "Gain"}, 1);
+    triggerChannelBox.onChange = [this] {
+        bool gainSource = triggerChannelBox.getSelectedItemIndex() == 2;
+        triggerLevelKnob.setVisible(!gainSource);
+        triggerGainLevelKnob.setVisible(gainSource);
+        audioProcessor.setUpdate();
+    };
+    triggerChannelAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.getParameters(),"TRIGCHANNEL",triggerChannelBox);
+    triggerChannelLabel.setText("Source", juce::dontSendNotification);
+    triggerChannelLabel.setJustificationType(juce::Justification::horizontallyCentred);
+    triggerChannelLabel.attachToComponent(&triggerChannelBox, true);
+    addAndMakeVisible(triggerChannelBox);
+
+    // averaging slider
+    averageKnob.setColour(juce::Slider::ColourIds::thumbColourId, juce::Colours::lightgrey);
+    averageKnob.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
+    averageKnob.setTextBoxStyle(juce::Slider::TextEntryBoxPosition::TextBoxBelow, false, 100, 20);
+    averageKnob.setTextValueSuffix(" sweeps");
+    averageKnob.onValueChange = [this] {audioProcessor.setUpdate();};
+    averageAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.getParameters(),"AVERAGE",averageKnob);
+    averageLabel.setText("Averaging", juce::dontSendNotification);
+    averageLabel.setJustificationType(juce::Justification::horizontallyCentred);
+    averageLabel.attachToComponent(&averageKnob, true);
+    addAndMakeVisible(averageKnob);
+
+    // max hold checkbox
+    maxHoldButton.onStateChange = [this] {audioProcessor.setUpdate();};
+    maxHoldAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.getParameters(),"MAXHOLD",maxHoldButton);
+    maxHoldLabel.setText("Max Hold", juce::dontSendNotification);
+    maxHoldLabel.setJustificationType(juce::Justification::horizontallyCentred);
+    maxHoldLabel.attachToComponent(&maxHoldButton, true);
+    addAndMakeVisible(maxHoldButton);
+
+    // persistence slider
+    persistenceKnob.setColour(juce::Slider::ColourIds::thumbColourId, juce::Colours::lightgrey);
+    persistenceKnob.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
+    persistenceKnob.setTextBoxStyle(juce::Slider::TextEntryBoxPosition::TextBoxRight, false, 60, 20);
+    persistenceKnob.setTextValueSuffix(" s");
+    persistenceAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.getParameters(),"PERSISTENCE",persistenceKnob);
+    persistenceLabel.setText("Persistence", juce::dontSendNotification);
+    persistenceLabel.setJustificationType(juce::Justification::horizontallyCentred);
+    persistenceLabel.attachToComponent(&persistenceKnob, true);
+    addAndMakeVisible(persistenceKnob);
+
+    // decimation selector
+    decimationBox.addItemList({"Min/Max", "LTTB"}, 1);
+    decimationBox.onChange = [this] {audioProcessor.setUpdate();};
+    decimationAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.getParameters(),"DECIMATION",decimationBox);
+    decimationLabel.setText("Decimation", juce::dontSendNotification);
+    decimationLabel.setJustificationType(juce::Justification::horizontallyCentred);
+    decimationLabel.attachToComponent(&decimationBox, true);
+    addAndMakeVisible(decimationBox);
+
+    // pixel cap selector
+    pixelCapBox.addItemList({"1024", "2048", "4096"}, 1);
+    pixelCapBox.onChange = [this] {updateNumPixels();};
+    pixelCapAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.getParameters(),"PIXELCAP",pixelCapBox);
+    pixelCapLabel.setText("Max Pixels", juce::dontSendNotification);
+    pixelCapLabel.setJustificationType(juce::Justification::horizontallyCentred);
+    pixelCapLabel.attachToComponent(&pixelCapBox, true);
+    addAndMakeVisible(pixelCapBox);
+
     // set visibility and enabled
     auto compMode = compressionButton.getToggleStateValue().getValue();
     auto freezeMode = freezeButton.getToggleStateValue().getValue();
     auto smoothingMode = smoothingButton.getToggleStateValue().getValue();
+    auto triggerMode = triggerButton.getToggleStateValue().getValue();
     timeKnob.setEnabled(!freezeMode);
     gainKnobs[0]->setVisible(!compMode);
     gainKnobs[1]->setVisible(!compMode);
@@ -179,6 +297,89 @@ CompressOScopeAudioProcessorEditor::CompressOScopeAudioProcessorEditor (Compress
     smoothingButton.setVisible(compMode);
     filterKnob.setVisible(compMode && smoothingMode);
     filterKnob.setEnabled(compMode && !freezeMode && smoothingMode);
+    triggerLevelKnob.setEnabled(triggerMode);
+    triggerGainLevelKnob.setEnabled(triggerMode);
+    triggerLevelKnob.setVisible(triggerChannelBox.getSelectedItemIndex() != 2);
+    triggerGainLevelKnob.setVisible(triggerChannelBox.getSelectedItemIndex() == 2);
+    triggerHoldoffKnob.setEnabled(triggerMode);
+    triggerSlopeBox.setEnabled(triggerMode);
+    triggerChannelBox.setEnabled(triggerMode);
+    averageKnob.setEnabled(triggerMode);
+    maxHoldButton.setEnabled(triggerMode);
+
+    //==========================================================================================//
+
+    /* set size */
+
+    // the scope window grows with the editor, up to the widest display the processor has buffers for
+    setResizable(true, true);
+    setResizeLimits(1000, 980, audioProcessor.MAX_NUM_PIXELS + 200, 2400);
+    setSize (1000, 980);
+
+    audioProcessor.setGuiReady(true);
+}
+
+CompressOScopeAudioProcessorEditor::~CompressOScopeAudioProcessorEditor()
+{
+    // the processor drops to capturing history only until the next editor opens
+    audioProcessor.setGuiReady(false);
+    scheduler->removeClient(this);
+    for(auto* param : audioProcessor.AudioProcessor::getParameters())
+    {
+        param->removeListener(this);
+    }
+}
+
+//==============================================================================
+void CompressOScopeAudioProcessorEditor::paint (juce::Graphics& g)
+{
+    auto paintStart = juce::Time::getHighResolutionTicks();
+
+    // the window has moved to a display with a different pixel density
+    if(juce::Component::getApproximateScaleFactorForComponent(this) != displayScale)
+    {
+        updateNumPixels();
+    }
+
+    // the axes, labels and logo only change with a handful of parameters, so they are drawn once and reused.
+    // they are drawn at the display's own resolution so the text stays sharp
+    auto timeAxis = getTimeAxis();
+    std::array<double, 6> staticView {timeAxis.getStart(), timeAxis.getLength(), yMinKnob.getValue(), yMaxKnob.getValue(),
+                                      double(compressionButton.getToggleState()), getSamplesPerPixel()};
+    int staticWidth = juce::roundToInt(getWidth() * displayScale);
+    int staticHeight = juce::roundToInt(getHeight() * displayScale);
+    if(staticLayer.getWidth() != staticWidth || staticLayer.getHeight() != staticHeight)
+    {
+        staticLayer = juce::Image(juce::Image::RGB, staticWidth, staticHeight, false);
+        drawnStaticView = {};
+    }
+    if(staticView != drawnStaticView)
+    {
+        juce::Graphics staticGraphics(staticLayer);
+        staticGraphics.addTransform(juce::AffineTransform::scale(displayScale));
+        drawStaticLayer(staticGraphics);
+        drawnStaticView = staticView;
+    }
+    g.drawImage(staticLayer, getLocalBounds().toFloat());
+
+    plot(g);
+
+    // the scheduler uses this to decide how many editors it can repaint in one frame
+    frameCost = 1000.0 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - paintStart);
+}
+
+void CompressOScopeAudioProcessorEditor::resized()
+{
+    //==========================================================================================//
+
+    /* oscilloscope window */
+
+    int padding = 50;
+    window.setSize(getWidth()-padding, getHeight()-580);
+    window.setLeft(padding*3);
+    window.setTop(padding);
+
+    updateNumPixels();
 
     //==========================================================================================//
 
@@ -186,6 +387,13 @@ CompressOScopeAudioProcessorEditor::CompressOScopeAudioProcessorEditor (Compress
     int spacing = 60;
     int gap = spacing*3/4;
 
+    pixelCapBox.setBounds(       getWidth()-740, 12                       , 90 , 25);
+    decimationBox.setBounds(     getWidth()-520, 12                       , 110, 25);
+    persistenceKnob.setBounds(   getWidth()-300, 10                       , 250, 30);
+    averageKnob.setBounds(       getWidth()/3  , getHeight()-spacing*7-gap, 400, 50);
+    triggerLevelKnob.setBounds(  getWidth()/3  , getHeight()-spacing*6-gap, 400, 50);
+    triggerGainLevelKnob.setBounds(getWidth()/3, getHeight()-spacing*6-gap, 400, 50);
+    triggerHoldoffKnob.setBounds(getWidth()/3  , getHeight()-spacing*5-gap, 400, 50);
     timeKnob.setBounds(          getWidth()/3  , getHeight()-spacing*4-gap, 400, 50);
     filterKnob.setBounds(        getWidth()/3  , getHeight()-spacing*1-gap, 400, 50);
     gainKnobs[0]->setBounds(     getWidth()/3  , getHeight()-spacing*3-gap, 400, 50);
@@ -195,58 +403,126 @@ CompressOScopeAudioProcessorEditor::CompressOScopeAudioProcessorEditor (Compress
     compressionButton.setBounds( getWidth()-100, getHeight()-spacing*2-gap, 25 , 25);
     freezeButton.setBounds(      getWidth()-100, getHeight()-spacing*3-gap, 25 , 25);
     smoothingButton.setBounds(   getWidth()-100, getHeight()-spacing*1-gap, 25 , 25);
+    maxHoldButton.setBounds(     getWidth()-100, getHeight()-spacing*7-gap, 25 , 25);
+    triggerButton.setBounds(     getWidth()-100, getHeight()-spacing*6-gap, 25 , 25);
+    triggerChannelBox.setBounds( getWidth()-130, getHeight()-spacing*5-gap, 110, 25);
+    triggerSlopeBox.setBounds(   getWidth()-130, getHeight()-spacing*4-gap, 110, 25);
+}
 
-    audioProcessor.setGuiReady(true);
+void CompressOScopeAudioProcessorEditor::updateNumPixels()
+{
+    // decimate to physical pixels so high density displays get all the detail they can show, up to the user's cap
+    displayScale = juce::Component::getApproximateScaleFactorForComponent(this);
+    int cap = juce::jmin(audioProcessor.MAX_NUM_PIXELS, 1024 << int(*audioProcessor.getParameters().getRawParameterValue("PIXELCAP")));
+    int numPixels = juce::jlimit(1, cap, juce::roundToInt(window.getWidth() * displayScale));
+
+    // the display buffer is only used on this thread, so it can simply follow the window
+    displayBuffer.setSize(audioProcessor.displayCollector.getNumChannels(), numPixels);
+    displayBuffer.clear();
+    liveView = {};
+    lastSequence = -1;
+    copyInStep = false;
+
+    // talk to audio thread
+    audioProcessor.setNumPixels(numPixels);
+    audioProcessor.setDisplayHeight(juce::roundToInt(window.getHeight() * displayScale));
 }
 
-CompressOScopeAudioProcessorEditor::~CompressOScopeAudioProcessorEditor()
+juce::Range<double> CompressOScopeAudioProcessorEditor::getTimeAxis()
 {
+    // while frozen the axis follows the part of the history on screen, counted back from the moment we froze
+    double sampleRate = audioProcessor.getSampleRate();
+    if(freezeButton.getToggleState() && sampleRate > 0)
+    {
+        double newest = (history.getNumSamples() - history.getStart() - history.getLength()) / sampleRate;
+        return {newest, newest + history.getLength() / sampleRate};
+    }
+    return {0.0, timeKnob.getValue()};
 }
 
-//==============================================================================
-void CompressOScopeAudioProcessorEditor::paint (juce::Graphics& g)
+double CompressOScopeAudioProcessorEditor::getSamplesPerPixel()
 {
-    g.setFont(f);
-    g.fillAll (juce::Colours::black);
-    g.setColour(juce::Colours::lightgrey);
+    if(freezeButton.getToggleState())
+    {
+        return history.getLength() / juce::jmax(1, displayBuffer.getNumSamples());
+    }
+    return audioProcessor.getNumSamplesPerPixel();
+}
 
-    plot(g);
+void CompressOScopeAudioProcessorEditor::mouseDown(const juce::MouseEvent& e)
+{
+    lastDragX = e.x;
+}
 
-    int xPos = 20;
-    int yPos = -20 + getHeight() - int(logo.getHeight()) - int(f.getHeight());
-    g.drawImageAt(logo, xPos, yPos);
-    write(ProjectInfo::versionString, xPos + logo.getWidth(), yPos + logo.getHeight() + 5, juce::Justification::right, g);
+void CompressOScopeAudioProcessorEditor::mouseDrag(const juce::MouseEvent& e)
+{
+    // dragging the frozen history moves it along with the mouse
+    if(freezeButton.getToggleState() && window.contains(e.getMouseDownPosition()))
+    {
+        history.pan(double(lastDragX - e.x) / window.getWidth());
+        parametersChanged = true;
+    }
+    lastDragX = e.x;
 }
 
-void CompressOScopeAudioProcessorEditor::resized()
+void CompressOScopeAudioProcessorEditor::mouseWheelMove(const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel)
 {
+    // scrolling zooms the frozen history in and out around the mouse
+    if(freezeButton.getToggleState() && window.contains(e.getPosition()))
+    {
+        history.zoom(std::pow(2.0, -4.0 * wheel.deltaY), double(e.x - window.getX()) / window.getWidth());
+        parametersChanged = true;
+    }
+    else
+    {
+        AudioProcessorEditor::mouseWheelMove(e, wheel);
+    }
 }
 
-void CompressOScopeAudioProcessorEditor::timerCallback()
+void CompressOScopeAudioProcessorEditor::parameterValueChanged(int /*parameterIndex*/, float /*newValue*/)
 {
-    repaint();
+    parametersChanged = true;
 }
 
-void CompressOScopeAudioProcessorEditor::write(juce::String txt, int xPos, int yPos, juce::Justification j, juce::Graphics& g)
+bool CompressOScopeAudioProcessorEditor::isFrameDue()
 {
-    if(j == juce::Justification::right)
+    bool newData = audioProcessor.displayCollector.getWriteSequence() != lastSequence;
+    // the persistence image decays every frame until it is empty, but isn't drawn at all while frozen
+    bool fading = persistenceKnob.getValue() > 0 && !freezeButton.getToggleState() && persistence.hasAnyContent();
+    bool zoomChanged = getSamplesPerPixel() != drawnStaticView[5];
+    bool newSnapshot = freezeButton.getToggleState() && audioProcessor.getNumSnapshots() != lastSnapshot;
+    return parametersChanged || zoomChanged || newData || fading || newSnapshot;
+}
+
+void CompressOScopeAudioProcessorEditor::requestFrame()
+{
+    // a parameter change (or the zoom it leads to) can move the axes as well as the traces
+    if(parametersChanged.exchange(false) || getSamplesPerPixel() != drawnStaticView[5])
     {
-        xPos -= f.getStringWidth(txt);
+        repaint();
+    }
+    // otherwise only the scope window needs redrawing
+    else
+    {
+        repaint(window);
     }
-    g.drawText(txt, xPos, yPos, f.getStringWidth(txt), int(f.getHeight()), j);
 }
 
-void CompressOScopeAudioProcessorEditor::plot(juce::Graphics& g)
+void CompressOScopeAudioProcessorEditor::write(const juce::String& txt, int xPos, int yPos, juce::Justification j, juce::Graphics& g)
 {
-    //==========================================================================================//
-
-    /* read data */
-    if(audioProcessor.displayCollector.getNumUnread() >= displayBuffer.getNumSamples() &&
-       !freezeButton.getToggleStateValue().getValue() &&
-       audioProcessor.isDoneProcessing())
+    int width = f.getStringWidth(txt);
+    if(j == juce::Justification::right)
     {
-        audioProcessor.displayCollector.readHead(displayBuffer);
+        xPos -= width;
     }
+    g.drawText(txt, xPos, yPos, width, int(f.getHeight()), j);
+}
+
+void CompressOScopeAudioProcessorEditor::drawStaticLayer(juce::Graphics& g)
+{
+    g.setFont(f);
+    g.fillAll (juce::Colours::black);
+    g.setColour(juce::Colours::lightgrey);
 
     //==========================================================================================//
 
@@ -274,18 +550,19 @@ void CompressOScopeAudioProcessorEditor::plot(juce::Graphics& g)
 
     // draw zoom level
     txt = "Zoom = ";
-    txt += juce::String(100.f * 1.f / audioProcessor.getNumSamplesPerPixel(), 1);
+    txt += juce::String(100.f * 1.f / getSamplesPerPixel(), 1);
     txt += "%";
     write(txt, r - 130, t + 50, jLeft, g);
 
     // draw x axis
+    auto timeAxis = getTimeAxis();
     float numXTicks = 5;
     for(float i = 0; i < numXTicks; i++)
     {
         float scale = i / (numXTicks - 1);
         int xPos = r - int(scale * w);
         g.drawRect(xPos, t, 1, tickSize); // tick
-        write(juce::String(scale * timeKnob.getValue(), 4), xPos - 17, t + 15, jCtr, g);
+        write(juce::String(timeAxis.getStart() + scale * timeAxis.getLength(), 4), xPos - 17, t + 15, jCtr, g);
     }
     write("Time (s)", l + w/2 - 25, t + 40, jCtr, g);
 
@@ -324,124 +601,256 @@ void CompressOScopeAudioProcessorEditor::plot(juce::Graphics& g)
 
     //==========================================================================================//
 
-    /* draw data */
+    /* draw logo */
 
-    if(!compMode) // oscilloscope mode
-    {
-        // lambda function to convert audio data into plot coordinate
-        auto valToCoord = [&](float v)
-        {
-            return juce::jlimit(b, t, b + int(juce::jmap(v, 1.f, -1.f, 0.f, float(h))));
-        };
+    int xPos = 20;
+    int yPos = -20 + getHeight() - int(logo.getHeight()) - fh;
+    g.drawImageAt(logo, xPos, yPos);
+    write(ProjectInfo::versionString, xPos + logo.getWidth(), yPos + logo.getHeight() + 5, jRight, g);
+}
 
-        for(size_t ch = 0; ch < size_t(audioProcessor.NUM_CH); ch++)
-        {
-            g.setColour(palette[ch]);
-            auto data = displayBuffer.getReadPointer(int(ch));
-            auto data_min = displayBuffer.getReadPointer(int(ch) + 3);
-            float gain = juce::Decibels::decibelsToGain(float(gainKnobs[ch]->getValue()));
+void CompressOScopeAudioProcessorEditor::plot(juce::Graphics& g)
+{
+    //==========================================================================================//
 
-            for (int i = 1; i < w; i++)
+    /* read data */
+    int newPixels = 0; // columns that have scrolled in since the last read
+    bool frozen = freezeButton.getToggleState();
+    if(frozen)
+    {
+        // the frozen history is decimated here from the raw samples, at whatever zoom we are looking at
+        if(audioProcessor.tryLockSnapshot())
+        {
+            if(audioProcessor.getNumSnapshots() != lastSnapshot)
             {
-                float d1, d2;
-
-                prepareFilledLine(data[i], data[i + 1], data_min[i], data_min[i + 1], d1, d2);
-
-                int x1 = i + l;
-                auto y1 = valToCoord(d1 * gain);
-                auto y2 = valToCoord(d2 * gain);
-
-                if(y1 < y2)
-                {
-                    std::swap(y1, y2);
-                }
+                // start on what was on screen when we froze
+                lastSnapshot = audioProcessor.getNumSnapshots();
+                history.reset(audioProcessor.getSnapshotLength(), timeKnob.getValue() * audioProcessor.getSampleRate());
+                parametersChanged = true; // the time axis has moved
+            }
 
-                g.fillRect(x1, y2, 1, 1 + (y1 - y2));
+            float gains[2] = {juce::Decibels::decibelsToGain(float(gainKnobs[0]->getValue())),
+                              juce::Decibels::decibelsToGain(float(gainKnobs[1]->getValue()))};
+            float yMin = float(yMinKnob.getValue());
+            float yMax = float(yMaxKnob.getValue());
+            if(yMin == yMax)
+            {
+                yMax += 0.0001f;
+            }
+            history.getMapper().setMapping(compressionButton.getToggleState(), gains, yMin, yMax, juce::roundToInt(window.getHeight() * displayScale));
+            auto& snapshot = audioProcessor.getSnapshot();
+            const float* channels[CompressOScopeAudioProcessor::AudioCollector::fixedNumChannels];
+            for(int ch = 0; ch < snapshot.getNumChannels(); ch++)
+            {
+                channels[ch] = snapshot.getReadPointer(ch);
             }
+            history.render(channels, snapshot.getSampleStride(), snapshot.getTotalSize(), audioProcessor.getSnapshotStart(), displayBuffer, displayBuffer.getNumSamples());
+            audioProcessor.unlockSnapshot();
+            newPixels = displayBuffer.getNumSamples();
+            copyInStep = false;
         }
     }
-    else // compression mode
+    else if(audioProcessor.displayCollector.getNumUnread() >= displayBuffer.getNumSamples() &&
+       audioProcessor.displayCollector.getWriteSequence() != lastSequence)
     {
-        // lambda function to convert compression data into plot coordinate
-        auto valToCoord = [&](float v)
-        {
-            return juce::jlimit(b, t, b + int(juce::jmap(juce::Decibels::gainToDecibels(v), yMax, yMin, 0.f, float(h))));
-        };
-        
-        g.setColour(palette[2]);
-        auto comp = displayBuffer.getReadPointer(2);
-        auto comp_min = displayBuffer.getReadPointer(2 + 3);
-
-        for (int i = 1; i < w; i++)
+        // the view stays pinned until the next read. the writer only laps it if we fall a whole buffer behind,
+        // and then the sequence has moved on anyway
+        liveView = audioProcessor.displayCollector.viewHead(displayBuffer.getNumSamples());
+        if(!liveView.isContiguous())
         {
-            float d1, d2;
-
-            prepareFilledLine(comp[i], comp[i + 1], comp_min[i], comp_min[i + 1], d1, d2);
-
-            int x1 = i + l;
-            int y1 = valToCoord(d1);
-            int y2 = valToCoord(d2);
-
-            if(comp[i] > 0 && comp[i + 1] > 0)
+            // the copy slides along and only the columns written since it was last brought up to date are read.
+            // if the writer got to any of them first, the whole window is copied again
+            auto numNew = liveView.getEndSequence() - displayReader.getSequence();
+            bool caughtUp = false;
+            if(copyInStep && numNew > 0 && numNew < displayBuffer.getNumSamples())
             {
-                if(y1 < y2)
+                int numKept = displayBuffer.getNumSamples() - int(numNew);
+                for(int ch = 0; ch < displayBuffer.getNumChannels(); ch++)
                 {
-                    std::swap(y1, y2);
+                    auto columns = displayBuffer.getWritePointer(ch);
+                    std::memmove(columns, columns + numNew, size_t(numKept) * sizeof(juce::int16));
                 }
-                g.fillRect(x1, y2, 1, 1 + (y1 - y2));
+                auto tail = SampleBlock<juce::int16>(displayBuffer).getSubBlock(size_t(numKept), size_t(numNew));
+                auto delta = displayReader.read(tail);
+                caughtUp = !delta.gap && delta.numRead == numNew;
             }
+            if(!caughtUp)
+            {
+                SampleBlock<juce::int16> block(displayBuffer);
+                liveView.copyTo(block);
+            }
+            displayReader.seek(liveView.getEndSequence());
+            copyInStep = true;
         }
+
+        // the view knows the sequence number of its newest column, so we can tell exactly how many are new.
+        // a reset collector moves the sequence on by more than the window and is drawn from scratch
+        if(lastSequence >= 0)
+        {
+            newPixels = int(juce::jlimit(juce::int64(0), juce::int64(displayBuffer.getNumSamples()), liveView.getEndSequence() - lastSequence));
+        }
+        else
+        {
+            newPixels = displayBuffer.getNumSamples();
+        }
+        lastSequence = liveView.getEndSequence();
     }
 
-    g.setColour(juce::Colours::lightgrey);
-    g.drawRect(window);
-}
+    //==========================================================================================//
 
-void CompressOScopeAudioProcessorEditor::prepareFilledLine(float v, float vNext, float vMin, float vMinNext, float &out1, float &out2)
-{
-    if(!isnan(vMin))
+    /* initialize variables*/
+
+    // the traces are drawn in display pixels, which can be finer than the window's logical ones
+    int w  = displayBuffer.getNumSamples() - 1;                       // window width
+    int h  = juce::roundToInt(window.getHeight() * displayScale) - 1; // window height
+    int numTraces = audioProcessor.NUM_CH + 1;
+    auto compMode = compressionButton.getToggleStateValue().getValue();
+    bool maxHold = triggerButton.getToggleState() && maxHoldButton.getToggleState();
+
+    //==========================================================================================//
+
+    /* draw data */
+
+    // everything is rasterized into one image, with (0, 0) at the top left of the window
+    bool imageChanged = rasterizer.prepare(w + 1, h + 1);
+
+    // with persistence on, the traces are accumulated into an image instead of drawn directly
+    float persistenceTime = float(persistenceKnob.getValue());
+    bool persistent = persistenceTime > 0 && !frozen; // the frozen history is redrawn whole every frame
+
+    // the image is kept between frames, so anything that changes how the traces are drawn means starting again.
+    // the processor resends the whole window when the gains or y range change
+    std::array<float, 4> view {float(bool(compMode)), float(maxHold), float(persistent), float(frozen)};
+    if(view != drawnView)
     {
-        out1 = v;
-        out2 = vMin;
+        imageChanged = true;
+        drawnView = view;
+    }
 
-        if(!isnan(vMinNext))
+    if(persistent)
+    {
+        if(persistence.prepare(rasterizer.getWidth(), rasterizer.getHeight(), numTraces))
         {
-            if(v < vMinNext)
-            {
-                out1 = vMinNext;
-            }
-            if(vMin > vNext)
+            for(int ch = 0; ch < numTraces; ch++)
             {
-                out2 = vNext;
+                persistence.setColour(ch, palette[ch]);
             }
         }
-        else
+        if(bool(compMode) != persistenceCompMode)
         {
-            if(v < vNext)
-            {
-                out1 = vNext;
-            }
-            if(vMin > vNext)
-            {
-                out2 = vNext;
-            }
+            persistence.clear();
+            persistenceCompMode = compMode;
+        }
+
+        // decay by however long it has actually been since the last frame
+        double now = juce::Time::getMillisecondCounterHiRes();
+        double elapsed = juce::jlimit(0.0, 1000.0, now - lastPersistenceTime);
+        lastPersistenceTime = now;
+        persistence.decay(float(std::exp(-elapsed / (1000.0 * persistenceTime))));
+    }
+
+    // the columns are read in place when they are in one piece, otherwise from the copy in displayBuffer
+    bool inPlace = !frozen && liveView.getNumSamples() == displayBuffer.getNumSamples() && liveView.isContiguous();
+    auto column = [&](int ch) {return inPlace ? liveView.getSegment(ch, 0) : displayBuffer.getReadPointer(ch);};
+
+    // columns from firstColumn on get drawn, everything to their left is already in the image
+    int firstColumn = 1;
+
+    // only new columns are added to the persistence image, so it counts how often the trace went through each pixel.
+    // a triggered sweep lands on the same columns as the last one, a rolling trace carries its history along
+    int addFrom = imageChanged ? 1 : juce::jmax(1, w - newPixels);
+    if(persistent)
+    {
+        if(imageChanged)
+        {
+            persistence.clear();
+        }
+        else if(!triggerButton.getToggleState())
+        {
+            persistence.scroll(newPixels);
         }
     }
     else
     {
-        out1 = v;
-        out2 = vNext;
+        if(imageChanged || newPixels >= w)
+        {
+            rasterizer.clear(juce::Colours::black);
+        }
+        else
+        {
+            // slide the old traces along and only draw the columns that are new
+            rasterizer.scroll(newPixels, juce::Colours::black);
+            firstColumn = w - newPixels;
+        }
+    }
 
-        if(!isnan(vMinNext))
+    // every column only depends on its own spans, so the window is drawn as column tiles in parallel.
+    // the persistence image is redrawn across the whole width, otherwise only the new columns are touched
+    auto drawTile = [&](int tileStart, int tileEnd)
+    {
+        int start = juce::jmax(firstColumn, tileStart);
+        int end = juce::jmin(w, tileEnd);
+
+        // the processor has already worked out which pixels each trace covers, traces it isn't showing are left empty
+        for(int ch = 0; ch < numTraces; ch++)
         {
-            if(v < vMinNext)
+            auto top = column(ch * 2);
+            auto bottom = column(ch * 2 + 1);
+
+            for (int i = start; i < end; i++)
             {
-                out2 = vMinNext;
-                if(v > vNext)
+                if(top[i] > bottom[i])
+                {
+                    continue;
+                }
+
+                if(persistent)
+                {
+                    if(i >= addFrom)
+                    {
+                        persistence.addSpan(ch, i, int(top[i]), int(bottom[i]));
+                    }
+                }
+                else
                 {
-                    out1 = vNext;
+                    rasterizer.fillSpan(i, int(top[i]), int(bottom[i]), palette[ch]);
                 }
             }
         }
+
+        if(persistent)
+        {
+            persistence.render(rasterizer.getImage(), tileStart, tileEnd);
+        }
+
+        // the max-hold envelope is drawn over the top
+        for(int ch = 0; ch < numTraces && maxHold; ch++)
+        {
+            auto holdColour = palette[ch].withAlpha(0.5f);
+            auto top = column(numTraces * 2 + ch * 2);
+            auto bottom = column(numTraces * 2 + ch * 2 + 1);
+
+            for (int i = start; i < end; i++)
+            {
+                if(top[i] <= bottom[i])
+                {
+                    rasterizer.blendSpan(i, int(top[i]), int(bottom[i]), holdColour);
+                }
+            }
+        }
+    };
+    tiles->run(persistent ? 0 : firstColumn, persistent ? w + 1 : w, h + 1, drawTile);
+
+    // the writer may have lapped the view while we were drawing from it, in which case some columns are torn.
+    // they are only known to be good once the drawing is done, otherwise the next frame starts from scratch
+    if(!frozen && liveView.getNumSamples() > 0 && !liveView.isIntact())
+    {
+        lastSequence = -1;
+        copyInStep = false;
     }
+
+    g.drawImage(rasterizer.getImage(), window.toFloat());
+
+    g.setColour(juce::Colours::lightgrey);
+    g.drawRect(window);
 }
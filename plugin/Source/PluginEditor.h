@@ -10,11 +10,16 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "PersistenceImage.h"
+#include "TraceRasterizer.h"
+#include "RenderScheduler.h"
+#include "TilePool.h"
+#include "HistoryView.h"
 
 //==============================================================================
 /**
 */
-class CompressOScopeAudioProcessorEditor  : public juce::AudioProcessorEditor, juce::Timer
+class CompressOScopeAudioProcessorEditor  : public juce::AudioProcessorEditor, public RenderScheduler::Client, juce::AudioProcessorParameter::Listener
 {
 public:
     CompressOScopeAudioProcessorEditor (CompressOScopeAudioProcessor&);
@@ -23,25 +28,58 @@ public:
     //==============================================================================
     void paint (juce::Graphics&) override;
     void resized() override;
+    void mouseDown(const juce::MouseEvent& e) override;
+    void mouseDrag(const juce::MouseEvent& e) override;
+    void mouseWheelMove(const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel) override;
 
-    void write(juce::String txt, int xPos, int yPos, juce::Justification j, juce::Graphics& g);
+    void write(const juce::String& txt, int xPos, int yPos, juce::Justification j, juce::Graphics& g);
+    void drawStaticLayer(juce::Graphics& g);
+    void updateNumPixels();
     void plot(juce::Graphics& g);
-    void prepareFilledLine(float v, float vNext, float vMin, float vMinNext, float &out1, float &out2);
+    juce::Range<double> getTimeAxis();
+    double getSamplesPerPixel();
+
+    bool isFrameDue() override;
+    void requestFrame() override;
+    inline double getFrameCost() override {return frameCost;}
 
 private:
-    void timerCallback() override;
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int /*parameterIndex*/, bool /*gestureIsStarting*/) override {}
     CompressOScopeAudioProcessor& audioProcessor;
-    juce::AudioBuffer<float> displayBuffer;
+    SampleBuffer<juce::int16> displayBuffer;
+    ASyncBuffer<juce::int16>::ReadView liveView; // the newest columns, drawn where they lie in the display collector
+    PersistenceImage persistence; // phosphor-style history of the traces
+    TraceRasterizer rasterizer; // the traces are drawn straight into its pixels
+    juce::int64 lastSequence; // the display collector's write sequence at the last read, or -1 if we lost track
+    ASyncBuffer<juce::int16>::Reader displayReader; // our own cursor into the display collector, just past the newest column in displayBuffer
+    bool copyInStep; // does displayBuffer hold the window that ends at displayReader?
+    std::array<float, 4> drawnView {}; // the display settings the trace image was drawn with
+    std::atomic<bool> parametersChanged {true}; // set from whichever thread changes a parameter
+    double frameCost; // how long the last paint took, in ms
+    juce::SharedResourcePointer<RenderScheduler> scheduler; // shared by every open editor
+    juce::SharedResourcePointer<TilePool> tiles; // worker threads that draw the scope window in column tiles
+    double lastPersistenceTime; // when the persistence image was last decayed, in ms
+    bool persistenceCompMode; // the mode the persistence image was drawn in
     juce::Rectangle<int> window;
+    float displayScale; // physical pixels per logical pixel on the display we were last painted on
+    juce::Image staticLayer; // background, axes, labels and logo
+    std::array<double, 6> drawnStaticView {}; // the time axis, y range, mode and zoom the static layer was drawn with
+    HistoryView history; // pan and zoom over the raw history while frozen
+    int lastSnapshot; // the processor's snapshot count when we last reset the history view
+    int lastDragX;
     /* parameters */
     juce::Label timeLabel, filterLabel, compressionLabel, freezeLabel, smoothingLabel, yMinLabel, yMaxLabel;
-    juce::Slider timeKnob, filterKnob, yMinKnob, yMaxKnob;
+    juce::Label triggerLabel, triggerLevelLabel, triggerGainLevelLabel, triggerHoldoffLabel, triggerSlopeLabel, triggerChannelLabel, averageLabel, maxHoldLabel, persistenceLabel, decimationLabel, pixelCapLabel;
+    juce::Slider timeKnob, filterKnob, yMinKnob, yMaxKnob, triggerLevelKnob, triggerGainLevelKnob, triggerHoldoffKnob, averageKnob, persistenceKnob;
+    juce::ComboBox triggerSlopeBox, triggerChannelBox, decimationBox, pixelCapBox;
     std::array<std::unique_ptr<juce::Slider>,2> gainKnobs;
     std::array<std::unique_ptr<juce::Label>,2> gainLabels;
     std::array<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>,2> gainAttachments;
-    juce::ToggleButton compressionButton, freezeButton, smoothingButton;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> timeAttachment, filterAttachment, yMinAttachment, yMaxAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> compressionAttachment, freezeAttachment, smoothingAttachment;
+    juce::ToggleButton compressionButton, freezeButton, smoothingButton, triggerButton, maxHoldButton;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> timeAttachment, filterAttachment, yMinAttachment, yMaxAttachment, triggerLevelAttachment, triggerGainLevelAttachment, triggerHoldoffAttachment, averageAttachment, persistenceAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> compressionAttachment, freezeAttachment, smoothingAttachment, triggerAttachment, maxHoldAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> triggerSlopeAttachment, triggerChannelAttachment, decimationAttachment, pixelCapAttachment;
     juce::Colour palette[4] {juce::Colours::dodgerblue, juce::Colours::firebrick, juce::Colours::lightgreen, juce::Colours::green};
     juce::Font f;
     juce::Image logo;
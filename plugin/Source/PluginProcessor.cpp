@@ -21,20 +21,36 @@ CompressOScopeAudioProcessor::CompressOScopeAudioProcessor()
                      #endif
                        )
 #endif
-                    , NUM_CH(2), displayCollector((NUM_CH + 1) * 2, 1), audioCollector(NUM_CH + 1, 1), medianFilter(1), guiReady(false), isInUse(false)
+                    , NUM_CH(2), displayCollector((NUM_CH + 1) * 4, 1), audioCollector(NUM_CH + 1, 1), spanMapper(NUM_CH + 1)
+                    , compMode(false), needsGain(true), firstActive(0), numActive(size_t(NUM_CH)), numPixels(0), requestedNumPixels(0), displayHeight(1), requestedDisplayHeight(1), frozen(false)
+                    , snapshot(NUM_CH + 1, 1), snapshotStart(0), snapshotLength(0), numSnapshots(0), snapshotLocked(false), collectorStart(0), guiReady(false), requestedGuiReady(false), headless(false)
+                    , requestedGeneration(0), awaitedGeneration(-1), appliedGeneration(0)
+                    , requiresUpdate(false), pendingState(nullptr), retiredState(nullptr), builtFilterOrder(-1)
+                    , triggered(false), sweeping(false), maxHold(false), pendingTrigger(-1), samplesCaptured(0), samplesConsumed(0)
+                    , publishedSamplesPerPixel(0), publishedState(0)
                     , parameters(*this, nullptr, "Parameters", createParameters())
 {
+    medianFilter = std::make_unique<MedianFilter>(1);
+    lttb = std::make_unique<LTTBDecimator>(NUM_CH + 1);
     inBuffer.setSize(NUM_CH + 1, 1);
-    outBuffer.setSize((NUM_CH + 1) * 2, 1);
+    outBuffer.setSize((NUM_CH + 1) * 3, 1);
     copyBuffer.setSize(NUM_CH + 1, 1);
 
     displayCollector.setIsOverwritable(true);
     audioCollector.setIsOverwritable(true);
+    // where the platform allows, no copy in or out of the collectors is split at the wrap.
+    // the snapshot has to be mirrored too, as it trades storage with the audio collector
+    displayCollector.setIsMirrored(true);
+    audioCollector.setIsMirrored(true);
+    snapshot.setIsMirrored(true);
     parameters.state = juce::ValueTree("Parameters");
 }
 
 CompressOScopeAudioProcessor::~CompressOScopeAudioProcessor()
 {
+    stopTimer();
+    delete pendingState.exchange(nullptr);
+    delete retiredState.exchange(nullptr);
 }
 
 //==============================================================================
@@ -102,13 +118,41 @@ void CompressOScopeAudioProcessor::changeProgramName (int /*index*/, const juce:
 //==============================================================================
 void CompressOScopeAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
+    // the display buffers are sized for the widest window so the editor can resize without us reallocating.
+    // We double the size to leave extra room to account for
+    // concurrent access between the audio and graphics threads
+    displayCollector.resize(MAX_NUM_PIXELS*2);
     displayCollector.reset();
 
+    // start the display off with a window of empty columns
+    spanMapper.prepare(MAX_NUM_PIXELS);
+    spanBuffer.setSize(spanMapper.getNumChannels(), MAX_NUM_PIXELS);
+    spanMapper.remap(spanBuffer, MAX_NUM_PIXELS);
+    displayCollector.push(spanBuffer);
+
+    sweepBuffer.setSize(outBuffer.getNumChannels(), MAX_NUM_PIXELS);
+
     audioCollector.resize(int(sampleRate)*5);
+    samplesCaptured = 0;
+    samplesConsumed = 0;
+    collectorStart = 0;
+
+    // the history is swapped into this when we freeze, so it has to match the collector exactly
+    while(snapshotLocked.exchange(true)) {}
+    snapshot.resize(audioCollector.getTotalSize());
+    snapshotStart = 0;
+    snapshotLength = 0;
+    snapshotLocked = false;
 
     copyBuffer.setSize(copyBuffer.getNumChannels(), samplesPerBlock);
 
-    setUpdate();
+    // the audio thread isn't running yet, so the first pipeline can go straight in.
+    // anything already built was for the old sample rate
+    delete pendingState.exchange(nullptr);
+    delete retiredState.exchange(nullptr);
+    requiresUpdate = false;
+    builtFilterOrder = -1; // the state we just dropped may have had the only filter of that order
+    applyPipelineState(*buildPipelineState());
 }
 
 void CompressOScopeAudioProcessor::releaseResources()
@@ -148,11 +192,133 @@ void CompressOScopeAudioProcessor::processBlock (juce::AudioBuffer<float>& buffe
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    if(requiresUpdate)
+    // whatever the editor last asked for, read once so it holds still for the whole block.
+    // only the latest value matters, so nothing the editor sets can be lost however long we have been stopped
+    guiReady = requestedGuiReady.load();
+    displayHeight = requestedDisplayHeight.load();
+
+    //==========================================================================================//
+
+    /* headless */
+
+    // an editor has just opened, but whatever is pending was built before it did.
+    // ask for a fresh state and stay headless until one has been picked up
+    if(guiReady && headless && awaitedGeneration < 0)
+    {
+        awaitedGeneration = ++requestedGeneration;
+        setUpdate();
+    }
+
+    // nobody sees the display without an editor, so we only keep the raw history for when one opens.
+    // the gain is kept unsmoothed, the median filter is most of the cost
+    if(!guiReady || (headless && appliedGeneration < awaitedGeneration))
+    {
+        auto copyBlock = juce::dsp::AudioBlock<float>(copyBuffer).getSubBlock(0, size_t(buffer.getNumSamples()));
+        copyBlock.getSubsetChannelBlock(0, size_t(NUM_CH)).copyFrom(juce::dsp::AudioBlock<float>(buffer));
+
+        auto in1 = copyBlock.getChannelPointer(0);
+        auto in2 = copyBlock.getChannelPointer(1);
+        auto out = copyBlock.getChannelPointer(size_t(NUM_CH));
+        for(int i = 0; i < buffer.getNumSamples(); i++)
+        {
+            out[i] = abs(in2[i]/in1[i]);
+        }
+
+        audioCollector.push(copyBlock);
+        samplesCaptured += buffer.getNumSamples();
+        headless = true;
+
+        if(!guiReady)
+        {
+            awaitedGeneration = -1;
+        }
+        else if(auto* next = pendingState.exchange(nullptr))
+        {
+            applyPipelineState(*next);
+            retiredState = next;
+        }
+        return;
+    }
+
+    //==========================================================================================//
+
+    /* freeze */
+
+    bool freeze = bool(*parameters.getRawParameterValue("FREEZE"));
+    if(freeze && !frozen && !snapshotLocked.exchange(true))
+    {
+        // hand the raw history to the editor by swapping buffers, the collector carries on with the old snapshot's memory
+        snapshotLength = int(juce::jmin(samplesCaptured - collectorStart, juce::int64(audioCollector.getTotalSize() - 1)));
+        snapshotStart = (audioCollector.swapContents(snapshot) + audioCollector.getTotalSize() - snapshotLength) % audioCollector.getTotalSize();
+        numSnapshots++;
+        snapshotLocked = false;
+        frozen = true;
+    }
+    else if(!freeze && frozen)
+    {
+        // start again from live audio, everything from before the freeze went with the snapshot
+        samplesConsumed = samplesCaptured;
+        collectorStart = samplesCaptured;
+        frozen = false;
+        setUpdate();
+    }
+
+    // nothing is displayed while we are frozen, so there is nothing to do
+    if(frozen)
+    {
+        return;
+    }
+
+    //==========================================================================================//
+
+    // the pipeline only does the work the visible traces need, so a new view has to set it up again
+    if(bool(*parameters.getRawParameterValue("COMPMODE")) != compMode)
+    {
+        setUpdate();
+    }
+
+    // a new pipeline is built on the message thread whenever the parameters change, we only have to pick it up
+    bool viewChanged = false;
+    if(auto* next = pendingState.exchange(nullptr))
+    {
+        bool wasCompMode = compMode;
+        applyPipelineState(*next);
+        retiredState = next;
+        viewChanged = compMode != wasCompMode;
+    }
+
+    if(headless || viewChanged)
+    {
+        // an editor has just opened, or the view now shows traces that were never decimated.
+        // go back far enough in the raw history to fill the window and let the loop below decimate it in one go
+        audioCollector.rewindTo(int(numPixels * samplesPerPixel + 2));
+        samplesConsumed = samplesCaptured - audioCollector.getNumUnread();
+        if(triggered)
+        {
+            // the detector was reset to look from now on, but the history may already hold a sweep
+            rearmTrigger(samplesConsumed);
+        }
+        headless = false;
+        awaitedGeneration = -1;
+    }
+
+    //==========================================================================================//
+
+    /* keep the display in step with the view */
+
+    float gains[2] = {juce::Decibels::decibelsToGain(float(*parameters.getRawParameterValue("GAIN1"))),
+                      juce::Decibels::decibelsToGain(float(*parameters.getRawParameterValue("GAIN2")))};
+    float yMin = *parameters.getRawParameterValue("YMIN");
+    float yMax = *parameters.getRawParameterValue("YMAX");
+    if(yMin == yMax)
     {
-        if(!guiReady) // if gui isn't ready then samplesPerPixel will be junk
-            return;
-        updateParameters();
+        yMax += 0.0001f;
+    }
+    if(spanMapper.setMapping(bool(*parameters.getRawParameterValue("COMPMODE")), gains, yMin, yMax, displayHeight))
+    {
+        // everything on screen was mapped with the old settings, so send the whole window again
+        spanMapper.remap(spanBuffer, numPixels);
+        pushSpans(numPixels);
     }
 
     //==========================================================================================//
@@ -169,13 +335,15 @@ void CompressOScopeAudioProcessor::processBlock (juce::AudioBuffer<float>& buffe
     auto in1 = audioCopyBlock.getChannelPointer(0);
     auto in2 = audioCopyBlock.getChannelPointer(1);
     auto out  = compCopyBlock.getChannelPointer(0);
+    // nobody is looking at the gain when needsGain is off, so it skips the median filter.
+    // the raw gain still goes into the history, so a frozen snapshot or a reopened editor can show it
     for(int i = 0; i < buffer.getNumSamples(); i++)
     {
         float compVal = abs(in2[i]/in1[i]);
-        if(smoothing)
+        if(smoothing && needsGain)
         {
-            medianFilter.push(compVal);
-            out[i] = medianFilter.getMedian();
+            medianFilter->push(compVal);
+            out[i] = medianFilter->getMedian();
         }
         else
         {
@@ -183,18 +351,54 @@ void CompressOScopeAudioProcessor::processBlock (juce::AudioBuffer<float>& buffe
         }
     }
 
+    /* look for a trigger */
+
+    if(triggered)
+    {
+        auto found = trigger.scan(copyBlock.getChannelPointer(size_t(triggerChannel)), buffer.getNumSamples(), samplesCaptured);
+        if(found >= 0)
+        {
+            pendingTrigger = found;
+        }
+    }
+
     audioCollector.push(copyBlock);
+    samplesCaptured += buffer.getNumSamples();
 
     //==========================================================================================//
 
     /* process data and send to display */
-    isInUse = true;
     while(audioCollector.getNumUnread() > inBuffer.getNumSamples())
     {
+        if(triggered && !sweeping)
+        {
+            // nothing is displayed until the trigger fires, so drop everything before it
+            if(pendingTrigger < 0)
+            {
+                int numToDrop = audioCollector.getNumUnread();
+                audioCollector.trim(numToDrop);
+                samplesConsumed += numToDrop;
+                break;
+            }
+
+            int numToDrop = int(juce::jmax(juce::int64(0), pendingTrigger - samplesConsumed));
+            audioCollector.trim(numToDrop);
+            samplesConsumed += numToDrop;
+
+            // the sweep starts exactly on the trigger sample
+            pendingTrigger = -1;
+            sweeping = true;
+            sweepPosition = 0;
+            counter = 1;
+            lttb->reset();
+            continue;
+        }
+
         auto inBlock = juce::dsp::AudioBlock<float>(inBuffer); // used to process samples read from collector
         auto outBlock = juce::dsp::AudioBlock<float>(outBuffer); // used to collect processed samples and push to the display
-        auto outValBlock = outBlock.getSubsetChannelBlock(0, size_t(NUM_CH + 1));
-        auto outMinBlock = outBlock.getSubsetChannelBlock(size_t(NUM_CH + 1), size_t(NUM_CH + 1));
+        // only the channels on screen are decimated, the rest were left as NaN when the pipeline was built
+        auto outValBlock = outBlock.getSubsetChannelBlock(firstActive, numActive);
+        auto outMinBlock = outBlock.getSubsetChannelBlock(size_t(NUM_CH + 1) + firstActive, numActive);
         outMinBlock.fill(NAN);
         int numToRead = int(counter*(samplesPerPixel)) - int((counter-1)*(samplesPerPixel));
         int numToWrite;
@@ -202,10 +406,11 @@ void CompressOScopeAudioProcessor::processBlock (juce::AudioBuffer<float>& buffe
         /* process zoomed audio data */
 
         // samples/pixels is 1
-        if(state == 1 || (state == 2 && numToRead == 1))
+        if(state == 1 || (state == 2 && numToRead == 1 && !useLTTB))
         {
             audioCollector.pop(inBlock,numToRead,numToRead);
-            inBlock = inBlock.getSubBlock(0, 1);
+            samplesConsumed += numToRead;
+            inBlock = inBlock.getSubBlock(0, 1).getSubsetChannelBlock(firstActive, numActive);
             outValBlock = outValBlock.getSubBlock(0, 1);
             outValBlock.copyFrom(inBlock);
             numToWrite = 1;
@@ -214,14 +419,23 @@ void CompressOScopeAudioProcessor::processBlock (juce::AudioBuffer<float>& buffe
         else if(state == 2)
         {
             audioCollector.pop(inBlock,numToRead,numToRead);
-            inBlock = inBlock.getSubBlock(0, size_t(numToRead));
+            samplesConsumed += numToRead;
+            inBlock = inBlock.getSubBlock(0, size_t(numToRead)).getSubsetChannelBlock(firstActive, numActive);
 
-            for(size_t ch = 0; ch < size_t(NUM_CH + 1); ch++)
+            if(useLTTB)
+            {
+                // one representative point per pixel, drawn as a line
+                lttb->process(inBlock, outValBlock, int(firstActive));
+            }
+            else
             {
-                auto curCh = inBlock.getSubsetChannelBlock(ch, 1);
-                juce::Range<float> minmax = curCh.findMinAndMax();
-                outValBlock.setSample(int(ch), 0, minmax.getStart());
-                outMinBlock.setSample(int(ch), 0, minmax.getEnd());
+                for(size_t ch = 0; ch < numActive; ch++)
+                {
+                    auto curCh = inBlock.getSubsetChannelBlock(ch, 1);
+                    juce::Range<float> minmax = curCh.findMinAndMax();
+                    outValBlock.setSample(int(ch), 0, minmax.getStart());
+                    outMinBlock.setSample(int(ch), 0, minmax.getEnd());
+                }
             }
             numToWrite = 1;
         }
@@ -230,91 +444,274 @@ void CompressOScopeAudioProcessor::processBlock (juce::AudioBuffer<float>& buffe
         {
             numToRead = 2;
             audioCollector.pop(inBlock,numToRead,numToRead - 1);
+            samplesConsumed += numToRead - 1;
             numToWrite = int(counter*(1/samplesPerPixel)) - int((counter-1)*(1/samplesPerPixel));
-            interpolate(inBlock, outValBlock, numToWrite, 1);
+            interpolate(inBlock.getSubsetChannelBlock(firstActive, numActive), outValBlock, numToWrite, 1);
         }
         else
         {
             numToWrite = 0;
         }
 
-        displayCollector.push(outBuffer,-1,numToWrite);
+        if(triggered)
+        {
+            // hold the sweep back until it is complete so the display always starts on the trigger
+            int numToCopy = juce::jmin(numToWrite, numPixels - sweepPosition);
+            for(int ch = 0; ch < sweepBuffer.getNumChannels(); ch++)
+            {
+                sweepBuffer.copyFrom(ch, sweepPosition, outBuffer, ch, 0, numToCopy);
+            }
+            sweepPosition += numToCopy;
 
-        // We leave a 20 sample allowance to account for concurrent access
-        while(displayCollector.getNumUnread() > numPixels + 20)
+            if(sweepPosition >= numPixels)
+            {
+                if(averager != nullptr)
+                {
+                    averager->addSweep(sweepBuffer, state == 2 && !useLTTB);
+                    if(numAverages > 1)
+                    {
+                        averager->getMean(sweepBuffer, state == 2 && !useLTTB);
+                    }
+                    if(maxHold)
+                    {
+                        averager->getHold(sweepBuffer, (NUM_CH + 1) * 2);
+                    }
+                }
+                spanMapper.push(sweepBuffer, numPixels, spanBuffer);
+                pushSpans(numPixels);
+                sweeping = false;
+                rearmTrigger(samplesConsumed + holdoffSamples);
+            }
+        }
+        else
         {
-            displayCollector.trim(1);
+            spanMapper.push(outBuffer, numToWrite, spanBuffer);
+            pushSpans(numToWrite);
         }
 
         counter++;
     }
-    isInUse = false;
 }
 
-void CompressOScopeAudioProcessor::updateParameters()
+std::unique_ptr<CompressOScopeAudioProcessor::PipelineState> CompressOScopeAudioProcessor::buildPipelineState()
 {
+    // runs on the message thread, so this is where everything that allocates happens
+    auto next = std::make_unique<PipelineState>();
+    next->generation = requestedGeneration.load(); // before any parameter is read
+    double sampleRate = getSampleRate();
+
     //==========================================================================================//
 
-    smoothing = bool(*parameters.getRawParameterValue("SMOOTHING"));
-    if(smoothing)
+    next->smoothing = bool(*parameters.getRawParameterValue("SMOOTHING"));
+    int filterOrder = next->smoothing ? int(sampleRate * *parameters.getRawParameterValue("FILTER")/1000.f) : 1;
+    if(filterOrder != builtFilterOrder)
     {
-        medianFilter.setOrder(int(getSampleRate() * *parameters.getRawParameterValue("FILTER")/1000.f));
-    }
-    else
-    {
-        medianFilter.setOrder(1);
+        // otherwise the running filter is kept, along with everything it has seen
+        next->medianFilter = std::make_unique<MedianFilter>(filterOrder);
+        builtFilterOrder = filterOrder;
     }
 
     //==========================================================================================//
 
-    samplesPerPixel = *parameters.getRawParameterValue("TIME")/numPixels * getSampleRate();
+    next->compMode = bool(*parameters.getRawParameterValue("COMPMODE"));
+    next->numPixels = juce::jmax(1, requestedNumPixels.load());
+    next->useLTTB = int(*parameters.getRawParameterValue("DECIMATION")) == 1;
+    next->samplesPerPixel = *parameters.getRawParameterValue("TIME")/next->numPixels * sampleRate;
 
+    int inSize, outSize;
     // one sample per pixel
-    if(samplesPerPixel == 1)
+    if(next->samplesPerPixel == 1)
     {
-        state = 1;
+        next->state = 1;
         // in this case, we simply write the audio buffer to the display buffer
-        inBuffer.setSize(inBuffer.getNumChannels(), 1);
-        outBuffer.setSize(displayCollector.getNumChannels(), 1); // does nothing
+        inSize = 1;
+        outSize = 1;
     }
     // multiple samples per pixel
-    else if(samplesPerPixel > 1)
+    else if(next->samplesPerPixel > 1)
     {
-        state = 2;
+        next->state = 2;
         // in this case, we need to find min and max values
-        inBuffer.setSize(inBuffer.getNumChannels(), int(samplesPerPixel) + 2);
-        outBuffer.setSize(displayCollector.getNumChannels(), 1); // stores min & max
+        inSize = int(next->samplesPerPixel) + 2;
+        outSize = 1; // stores min & max
     }
     // multiple pixels per sample
     else
     {
-        state = 3;
+        next->state = 3;
         // in this case, we interpolate between the two samples that we have
-        inBuffer.setSize(inBuffer.getNumChannels(), 2);
-        outBuffer.setSize(displayCollector.getNumChannels(), int(1/(samplesPerPixel) + 2)); // stores interpolated samples
+        inSize = 2;
+        outSize = int(1/(next->samplesPerPixel) + 2); // stores interpolated samples
+    }
+    next->inBuffer.setSize(NUM_CH + 1, inSize);
+    next->outBuffer.setSize((NUM_CH + 1) * 3, outSize);
+    next->lttb = std::make_unique<LTTBDecimator>(NUM_CH + 1);
+    next->lttb->prepare(inSize);
+
+    // the max-hold channels are only ever filled in by the averager, and hidden traces aren't decimated at all
+    size_t firstShown = next->compMode ? size_t(NUM_CH) : 0;
+    size_t numShown = next->compMode ? 1 : size_t(NUM_CH);
+    for(int ch = 0; ch < next->outBuffer.getNumChannels(); ch++)
+    {
+        auto trace = size_t(ch % (NUM_CH + 1));
+        bool isShown = trace >= firstShown && trace < firstShown + numShown;
+        if(ch >= (NUM_CH + 1) * 2 || !isShown)
+        {
+            juce::FloatVectorOperations::fill(next->outBuffer.getWritePointer(ch), NAN, next->outBuffer.getNumSamples());
+        }
+    }
+
+    //==========================================================================================//
+
+    next->triggered = bool(*parameters.getRawParameterValue("TRIGGER"));
+    next->triggerChannel = int(*parameters.getRawParameterValue("TRIGCHANNEL"));
+    next->holdoffSamples = juce::int64(sampleRate * *parameters.getRawParameterValue("TRIGHOLDOFF")/1000.f);
+    // the audio channels are bipolar, so their level is linear and signed. only the gain is set in dB
+    next->triggerLevel = next->triggerChannel == 2 ? juce::Decibels::decibelsToGain(float(*parameters.getRawParameterValue("TRIGGAINLEVEL")))
+                                                   : float(*parameters.getRawParameterValue("TRIGLEVEL"));
+    next->triggerRising = int(*parameters.getRawParameterValue("TRIGSLOPE")) == 0;
+
+    next->numAverages = int(*parameters.getRawParameterValue("AVERAGE"));
+    next->maxHold = bool(*parameters.getRawParameterValue("MAXHOLD"));
+    if(next->triggered && (next->numAverages > 1 || next->maxHold))
+    {
+        // the history is numAverages whole sweeps, so it is only worth having while we average or hold
+        next->averager = std::make_unique<SweepAverager>(NUM_CH + 1);
+        next->averager->prepare(next->numAverages, next->numPixels);
+    }
+
+    return next;
+}
+
+void CompressOScopeAudioProcessor::applyPipelineState(PipelineState& next)
+{
+    // runs on the audio thread. everything was allocated when the state was built, so this only copies and swaps,
+    // and whatever we swap out goes back with the state to be freed
+    appliedGeneration = next.generation;
+    smoothing = next.smoothing;
+    if(next.medianFilter != nullptr)
+    {
+        medianFilter.swap(next.medianFilter);
     }
 
     //==========================================================================================//
 
-    // if the window size has been changed
-    if(numPixels*2 != displayCollector.getTotalSize() && numPixels > 0)
+    compMode = next.compMode;
+    firstActive = compMode ? size_t(NUM_CH) : 0; // compression mode only shows the gain, otherwise only the audio is shown
+    numActive = compMode ? 1 : size_t(NUM_CH);
+
+    numPixels = next.numPixels;
+    useLTTB = next.useLTTB;
+    samplesPerPixel = next.samplesPerPixel;
+    state = next.state;
+    std::swap(inBuffer, next.inBuffer);
+    std::swap(outBuffer, next.outBuffer);
+    lttb.swap(next.lttb);
+
+    //==========================================================================================//
+
+    bool wasHolding = triggered && maxHold;
+    triggered = next.triggered;
+    triggerChannel = next.triggerChannel;
+    needsGain = compMode || (triggered && triggerChannel == NUM_CH);
+    holdoffSamples = next.holdoffSamples;
+    trigger.setParameters(next.triggerLevel, next.triggerRising);
+
+    numAverages = next.numAverages;
+    maxHold = next.maxHold;
+
+    // the hold spans weren't sent while nobody was drawing them, so the whole window needs them again
+    if(triggered && maxHold && !wasHolding)
     {
-        // We double the size to leave extra room to account for
-        // concurrent access between the audio and graphics threads
-        displayCollector.resize(numPixels*2);
-        if(displayCollector.getNumUnread() == 0)
+        spanMapper.remap(spanBuffer, numPixels);
+        pushSpans(numPixels);
+    }
+
+    // any sweep in progress was collected with the old settings
+    trigger.reset(samplesCaptured);
+    sweeping = false;
+    pendingTrigger = -1;
+
+    //==========================================================================================//
+
+    // the sweep buffer was allocated for the widest window in prepareToPlay, so a resize doesn't reallocate.
+    // the averager comes fresh with every state, or not at all
+    sweepBuffer.setSize(outBuffer.getNumChannels(), numPixels, false, false, true);
+    averager.swap(next.averager);
+
+    counter = 1;
+
+    publishedSamplesPerPixel = samplesPerPixel;
+    publishedState = state;
+}
+
+void CompressOScopeAudioProcessor::pushSpans(int numColumns)
+{
+    // the max-hold spans are only drawn over triggered sweeps, the rest of the time they stay behind
+    size_t numToSend = size_t(triggered && maxHold ? spanBuffer.getNumChannels() : spanBuffer.getNumChannels() / 2);
+    displayCollector.push(SampleBlock<juce::int16>(spanBuffer).getSubsetChannelBlock(0, numToSend), numColumns);
+}
+
+void CompressOScopeAudioProcessor::rearmTrigger(juce::int64 armFrom)
+{
+    if(armFrom > samplesCaptured)
+    {
+        trigger.rearm(armFrom);
+        return;
+    }
+
+    // everything we already have was scanned while the sweep was still being collected, so go over it again.
+    // starting one sample early gives the detector something to compare the first armed sample against,
+    // and it carries on to the newest sample so the next block picks up where this leaves off
+    trigger.reset(armFrom);
+    auto writeSequence = audioCollector.getWriteSequence();
+    auto from = armFrom - 1;
+    while(from < samplesCaptured)
+    {
+        auto delta = audioCollector.readSince(writeSequence - (samplesCaptured - from), juce::dsp::AudioBlock<float>(copyBuffer));
+        if(delta.numRead <= 0)
         {
-            juce::AudioBuffer<float> init;
-            init.setSize(displayCollector.getNumChannels(), displayCollector.getTotalSize() - 1);
-            juce::dsp::AudioBlock<float> initWithNAN;
-            initWithNAN.fill(NAN);
-            displayCollector.push(init);
+            break;
         }
+
+        auto first = samplesCaptured - (writeSequence - (delta.sequence - delta.numRead));
+        auto found = trigger.scan(copyBuffer.getReadPointer(triggerChannel), delta.numRead, first);
+        if(found >= 0)
+        {
+            pendingTrigger = found;
+        }
+        from = first + delta.numRead;
     }
+}
 
-    counter = 1;
+void CompressOScopeAudioProcessor::setGuiReady(bool r)
+{
+    requestedGuiReady = r;
 
-    requiresUpdate = false;
+    // parameter changes are turned into a new pipeline on the message thread, but only an editor ever looks at one.
+    // without an editor the timer stops once it has nothing left to free, the next editor starts it again
+    if(r)
+    {
+        startTimerHz(60);
+    }
+}
+
+void CompressOScopeAudioProcessor::timerCallback()
+{
+    // free whatever the audio thread swapped out since last time
+    delete retiredState.exchange(nullptr);
+
+    // only one state is ever in flight, so the audio thread always has an empty slot to retire the old one into
+    if(requestedGuiReady && pendingState == nullptr && retiredState == nullptr && getSampleRate() > 0 && requiresUpdate.exchange(false))
+    {
+        pendingState = buildPipelineState().release();
+    }
+
+    // anything asked for without an editor stays in requiresUpdate until the next one opens
+    if(!requestedGuiReady && retiredState == nullptr)
+    {
+        stopTimer();
+    }
 }
 
 void CompressOScopeAudioProcessor::interpolate(const juce::dsp::AudioBlock<float> inBlock, juce::dsp::AudioBlock<float>& outBlock, float n, int type)
@@ -354,6 +751,17 @@ juce::AudioProcessorValueTreeState::ParameterLayout CompressOScopeAudioProcessor
     params.push_back(std::make_unique<juce::AudioParameterBool >("COMPMODE" , "Comp Mode", false                                                                ));
     params.push_back(std::make_unique<juce::AudioParameterBool >("FREEZE"   , "Freeze"   , false                                                                ));
     params.push_back(std::make_unique<juce::AudioParameterBool >("SMOOTHING", "Smoothing", true                                                                 ));
+    params.push_back(std::make_unique<juce::AudioParameterBool  >("TRIGGER"    , "Trigger"        , false                                                            ));
+    params.push_back(std::make_unique<juce::AudioParameterFloat >("TRIGLEVEL"  , "Trigger Level"  , juce::NormalisableRange<float>(-1.f   , 1.f   , 0.0001f       ), 0.f  ));
+    params.push_back(std::make_unique<juce::AudioParameterFloat >("TRIGGAINLEVEL", "Trigger Gain Level", juce::NormalisableRange<float>(-60.f, 12.f, 0.001f       ), -12.f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat >("TRIGHOLDOFF", "Trigger Holdoff", juce::NormalisableRange<float>(0.f    , 1000.f, 0.01f         ), 0.f  ));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("TRIGSLOPE"  , "Trigger Slope"  , juce::StringArray {"Rising", "Falling"}                   , 0    ));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("TRIGCHANNEL", "Trigger Channel", juce::StringArray {"Input", "Output", "Gain"}             , 0    ));
+    params.push_back(std::make_unique<juce::AudioParameterInt   >("AVERAGE"    , "Averaging"      , 1, MAX_AVERAGES                                          , 1    ));
+    params.push_back(std::make_unique<juce::AudioParameterBool  >("MAXHOLD"    , "Max Hold"       , false                                                            ));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("DECIMATION" , "Decimation"     , juce::StringArray {"Min/Max", "LTTB"}                    , 0    ));
+    params.push_back(std::make_unique<juce::AudioParameterFloat >("PERSISTENCE", "Persistence"    , juce::NormalisableRange<float>(0.f    , 5.f   , 0.01f , 0.5f  ), 0.f  ));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("PIXELCAP"   , "Max Pixels"     , juce::StringArray {"1024", "2048", "4096"}              , 1    ));
 
     return { params.begin(), params.end() };
 }
@@ -11,11 +11,16 @@
 #include <JuceHeader.h>
 #include "ASyncBuffer.h"
 #include "MedianFilter.h"
+#include "TriggerDetector.h"
+#include "SweepAverager.h"
+#include "LTTBDecimator.h"
+#include "SpanMapper.h"
+#include "ScopeControl.h"
 
 //==============================================================================
 /**
 */
-class CompressOScopeAudioProcessor  : public juce::AudioProcessor
+class CompressOScopeAudioProcessor  : public juce::AudioProcessor, private juce::Timer
 {
 public:
     //==============================================================================
@@ -60,32 +65,102 @@ public:
 
     /* my functions */
     inline void setUpdate() {requiresUpdate = true;}
-    inline void setNumPixels(int num) {numPixels = num;}
-    inline void setGuiReady(bool r) {guiReady = r;}
-    inline double getNumSamplesPerPixel() {return samplesPerPixel;}
-    inline int getState() {return state;}
-    inline bool isDoneProcessing() {return !isInUse;}
+    inline void setNumPixels(int num) {requestedNumPixels = juce::jlimit(1, MAX_NUM_PIXELS, num); setUpdate();}
+    inline void setDisplayHeight(int h) {requestedDisplayHeight = h;}
+    void setGuiReady(bool r);
+    inline double getNumSamplesPerPixel() {return publishedSamplesPerPixel.load();}
+    inline int getState() {return publishedState.load();}
+
+    /* frozen history, only touch it while holding the lock */
+    inline bool tryLockSnapshot() {return !snapshotLocked.exchange(true);}
+    inline void unlockSnapshot() {snapshotLocked = false;}
+    inline const AudioCollector& getSnapshot() {return snapshot;}
+    inline int getSnapshotStart() {return snapshotStart;}
+    inline int getSnapshotLength() {return snapshotLength;}
+    inline int getNumSnapshots() {return numSnapshots;}
 
-    void updateParameters();
     void interpolate(const juce::dsp::AudioBlock<float> inBlock, juce::dsp::AudioBlock<float>& outBlock, float numInterps, int type = 0);
 
     const int NUM_CH; // we require 2 channels to run the compressoscope!
-    ASyncBuffer displayCollector; // we are going to access this from the graphics thread (yes, i know)
+    static constexpr int MAX_AVERAGES = 64; // most triggered sweeps we will average together
+    static constexpr int MAX_NUM_PIXELS = 4096; // widest display window, everything is allocated for this up front
+    using AudioCollector = ASyncBuffer<float, InterleavedLayout, 3>; // both inputs and the gain, one frame per sample
+    ASyncBuffer<juce::int16> displayCollector; // pixel spans ready to draw, we are going to access this from the graphics thread (yes, i know)
 
 private:
-    ASyncBuffer audioCollector; // collects raw audio data circularly
+    /* everything a parameter change needs, built on the message thread so the audio thread
+       never allocates. it is handed over with one pointer exchange and sent back to be freed */
+    struct PipelineState
+    {
+        bool smoothing, compMode, useLTTB, triggered, maxHold, triggerRising;
+        int numPixels, state, triggerChannel, numAverages;
+        double samplesPerPixel;
+        float triggerLevel;
+        juce::int64 holdoffSamples;
+        int generation; // requestedGeneration when the build started
+        juce::AudioBuffer<float> inBuffer, outBuffer;
+        std::unique_ptr<MedianFilter> medianFilter; // only when the order changes, otherwise the running filter is kept
+        std::unique_ptr<LTTBDecimator> lttb;
+        std::unique_ptr<SweepAverager> averager; // only when sweeps are averaged or held, sized for just that many
+    };
+    std::unique_ptr<PipelineState> buildPipelineState();
+    void applyPipelineState(PipelineState& next);
+    void pushSpans(int numColumns);
+    void rearmTrigger(juce::int64 armFrom);
+    void timerCallback() override;
+
+    AudioCollector audioCollector; // collects raw audio data circularly
     juce::AudioBuffer<float> inBuffer; // stores data read from the audiocollector
     juce::AudioBuffer<float> outBuffer; // stores the processed samples and pushes them to the display collector
     juce::AudioBuffer<float> copyBuffer; // copies from the buffer to the collector
-    MedianFilter medianFilter; // smooths the data
+    std::unique_ptr<MedianFilter> medianFilter; // smooths the data
+    std::unique_ptr<LTTBDecimator> lttb; // picks representative points instead of min/max when zoomed out
+    TriggerDetector trigger; // finds the sample each triggered sweep starts on
+    juce::AudioBuffer<float> sweepBuffer; // collects a triggered sweep before it is sent to the display
+    SpanMapper spanMapper; // maps the decimated columns to pixels for the display
+    SampleBuffer<juce::int16> spanBuffer; // the mapped columns on their way to the display collector
+    std::unique_ptr<SweepAverager> averager; // averages triggered sweeps to pull them out of the noise, only there while it is needed
     bool smoothing; // is smoothing on?
+    bool useLTTB; // decimate with LTTB rather than min/max?
+    bool compMode; // are we showing the gain rather than the audio?
+    bool needsGain; // does the gain trace or the trigger need the gain channel?
+    size_t firstActive, numActive; // the channels of the current view, nothing else gets decimated
     double samplesPerPixel;
     int numPixels; // width of the waveform display window
+    std::atomic<int> requestedNumPixels; // set by the editor, picked up when the next pipeline is built
+    int displayHeight; // height of the display window in pixels
+    std::atomic<int> requestedDisplayHeight; // set by the editor, picked up at the top of each block
+    bool frozen; // is the display frozen?
+    AudioCollector snapshot; // the raw history at the moment we froze, swapped out of the audio collector
+    int snapshotStart; // index of the oldest sample in the snapshot
+    int snapshotLength; // number of samples in the snapshot
+    StatusValue<int> numSnapshots; // lets the editor tell when there is a new snapshot
+    std::atomic<bool> snapshotLocked; // held by whichever thread is using the snapshot
+    juce::int64 collectorStart; // samplesCaptured when the audio collector last started from empty
     int state; // switches between methods of converting the audio data to display data
-    bool guiReady; // has the gui been initialized?
-    bool isInUse; // are we writing to the display window?
+    bool guiReady; // is an editor open and initialized?
+    std::atomic<bool> requestedGuiReady; // set by the editor, picked up at the top of each block
+    bool headless; // have we been running without an editor?
+    std::atomic<int> requestedGeneration; // bumped by the audio thread when only a state built from now on will do
+    int awaitedGeneration; // the state an editor that has just opened is waiting for, or -1
+    int appliedGeneration; // generation of the running pipeline
     unsigned long counter;
-    bool requiresUpdate; // have the VST parameters changed?
+    std::atomic<bool> requiresUpdate; // have the VST parameters changed?
+    std::atomic<PipelineState*> pendingState; // built and waiting for the audio thread
+    std::atomic<PipelineState*> retiredState; // swapped out and waiting to be freed on the message thread
+    int builtFilterOrder; // the median filter order of the last pipeline we built
+    bool triggered; // is the trigger on?
+    bool sweeping; // are we collecting a triggered sweep?
+    bool maxHold; // do we send the max-hold envelope along with the sweeps?
+    int numAverages; // number of sweeps averaged together
+    int triggerChannel; // 0 = input, 1 = output, 2 = gain
+    int sweepPosition; // number of pixels collected in the current sweep
+    juce::int64 holdoffSamples; // minimum gap between the end of a sweep and the next trigger
+    juce::int64 pendingTrigger; // absolute sample index of the next sweep, or -1
+    juce::int64 samplesCaptured; // total samples pushed to the audio collector
+    juce::int64 samplesConsumed; // total samples read (or dropped) from the audio collector
+    StatusValue<double> publishedSamplesPerPixel; // samplesPerPixel and state, as the editor sees them
+    StatusValue<int> publishedState;
     juce::AudioProcessorValueTreeState parameters; // stores the current state of the VST for saving
 
     //==============================================================================
@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    RenderScheduler.cpp
+    Created: 19 Oct 2026 6:02:41pm
+    Author:  Michael Nuzzo
+
+  ==============================================================================
+*/
+
+#include "RenderScheduler.h"
+
+RenderScheduler::RenderScheduler() : nextClient(0)
+{
+}
+
+RenderScheduler::~RenderScheduler()
+{
+    stopTimer();
+}
+
+void RenderScheduler::addClient(Client* client)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    clients.addIfNotAlreadyThere(client);
+    attachClock();
+}
+
+void RenderScheduler::removeClient(Client* client)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    clients.removeFirstMatchingValue(client);
+    nextClient = 0;
+    attachClock();
+}
+
+void RenderScheduler::attachClock()
+{
+#if JUCE_MAJOR_VERSION >= 7
+    // the vblank attachment needs a component on screen, so borrow the first editor that is showing
+    vBlankAttachment.reset();
+    clockComponent = nullptr;
+    for(auto* client : clients)
+    {
+        auto* component = dynamic_cast<juce::Component*>(client);
+        if(component != nullptr && component->isShowing() && component->getPeer() != nullptr)
+        {
+            vBlankAttachment = std::make_unique<juce::VBlankAttachment>(component, [this] {tick();});
+            clockComponent = component;
+            break;
+        }
+    }
+#endif
+
+    // the timer keeps running underneath, it ticks whenever there is no attachment to do it
+    if(clients.isEmpty())
+    {
+        stopTimer();
+    }
+    else if(!isTimerRunning())
+    {
+        startTimerHz(60);
+    }
+}
+
+bool RenderScheduler::isClockAttached()
+{
+#if JUCE_MAJOR_VERSION >= 7
+    // a hidden or minimised editor stops getting vblanks, which would freeze every scope
+    return clockComponent != nullptr && clockComponent->isShowing() && clockComponent->getPeer() != nullptr;
+#else
+    return false;
+#endif
+}
+
+void RenderScheduler::timerCallback()
+{
+    if(isClockAttached())
+    {
+        return;
+    }
+
+    // move the attachment to another editor if one is on screen, otherwise tick from here until one is
+    attachClock();
+    if(!isClockAttached())
+    {
+        tick();
+    }
+}
+
+void RenderScheduler::tick()
+{
+    int numClients = clients.size();
+    double spent = 0;
+
+    for(int n = 0; n < numClients; n++)
+    {
+        int index = (nextClient + n) % numClients;
+        auto* client = clients.getUnchecked(index);
+        if(!client->isFrameDue())
+        {
+            continue;
+        }
+
+        // always let one through, then stop once the frame is used up. whoever missed out goes first next time
+        double cost = client->getFrameCost();
+        if(spent > 0 && spent + cost > FRAME_BUDGET_MS)
+        {
+            nextClient = index;
+            return;
+        }
+
+        client->requestFrame();
+        spent += cost;
+    }
+
+    nextClient = numClients > 0 ? (nextClient + 1) % numClients : 0;
+}
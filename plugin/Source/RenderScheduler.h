@@ -0,0 +1,52 @@
+/*
+ ==============================================================================
+
+ RenderScheduler.h
+ Created: 19 Oct 2026 6:02:41pm
+ Author:  Michael Nuzzo
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/* one clock for every open scope window in the process. hold it with a
+   juce::SharedResourcePointer so it lives as long as any editor does */
+class RenderScheduler : private juce::Timer
+{
+public:
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+        virtual bool isFrameDue() = 0; // is there anything new to draw?
+        virtual void requestFrame() = 0; // repaint whatever needs it
+        virtual double getFrameCost() = 0; // how long the last paint took, in ms
+    };
+
+    RenderScheduler();
+    ~RenderScheduler() override;
+
+    void addClient(Client* client);
+    void removeClient(Client* client);
+
+    static constexpr double FRAME_BUDGET_MS = 8.0; // message thread time we let repaints take each frame
+
+private:
+    void timerCallback() override;
+    void tick();
+    void attachClock();
+    bool isClockAttached();
+
+    juce::Array<Client*> clients;
+    int nextClient; // where the next tick starts, so nobody is always last in the queue
+#if JUCE_MAJOR_VERSION >= 7
+    std::unique_ptr<juce::VBlankAttachment> vBlankAttachment; // ticks with the display of the first client on screen
+    juce::Component::SafePointer<juce::Component> clockComponent; // the client the attachment is bound to
+#endif
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderScheduler)
+};
@@ -0,0 +1,88 @@
+/*
+ ==============================================================================
+
+ SampleBuffer.h
+ Created: 19 Oct 2026 11:48:05pm
+ Author:  Michael Nuzzo
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/* juce's AudioBuffer and AudioBlock only take floating point samples. these are
+   the few parts of them we need for anything else, like the int16 pixel spans.
+   a SampleBlock points into channels owned by someone else, a SampleBuffer owns them */
+template <typename SampleType>
+class SampleBlock
+{
+public:
+    SampleBlock() : channels(nullptr), numChannels(0), startSample(0), numSamples(0) {}
+    SampleBlock(SampleType* const* channelData, size_t numberOfChannels, size_t numberOfSamples, size_t firstSample = 0)
+        : channels(channelData), numChannels(numberOfChannels), startSample(firstSample), numSamples(numberOfSamples) {}
+
+    // like an AudioBlock, any buffer with channel pointers can be passed where a block is expected
+    template <typename BufferType, typename = std::enable_if_t<!std::is_same<BufferType, SampleBlock>::value>>
+    SampleBlock(BufferType& buffer)
+        : channels(buffer.getArrayOfWritePointers()), numChannels(size_t(buffer.getNumChannels())), startSample(0), numSamples(size_t(buffer.getNumSamples())) {}
+
+    inline size_t getNumChannels() const {return numChannels;}
+    inline size_t getNumSamples() const {return numSamples;}
+    inline SampleType* getChannelPointer(size_t channel) const {return channels[channel] + startSample;}
+    inline SampleBlock getSubsetChannelBlock(size_t first, size_t num) const {return {channels + first, num, numSamples, startSample};}
+    inline SampleBlock getSubBlock(size_t first, size_t num) const {return {channels, numChannels, num, startSample + first};}
+
+private:
+    SampleType* const* channels;
+    size_t numChannels, startSample, numSamples;
+};
+
+template <typename SampleType>
+class SampleBuffer
+{
+public:
+    SampleBuffer() : numChannels(0), numSamples(0), allocatedSamples(0), allocatedChannels(0) {}
+    SampleBuffer(int numberOfChannels, int numberOfSamples) : SampleBuffer() {setSize(numberOfChannels, numberOfSamples);}
+
+    // the contents are lost, but the storage is only reallocated when it grows
+    void setSize(int numberOfChannels, int numberOfSamples)
+    {
+        if(numberOfChannels * numberOfSamples > allocatedSamples)
+        {
+            allocatedSamples = numberOfChannels * numberOfSamples;
+            data.allocate(size_t(allocatedSamples), true);
+        }
+        if(numberOfChannels > allocatedChannels)
+        {
+            allocatedChannels = numberOfChannels;
+            channels.allocate(size_t(allocatedChannels), true);
+        }
+        numChannels = numberOfChannels;
+        numSamples = numberOfSamples;
+        for(int ch = 0; ch < numChannels; ch++)
+        {
+            channels[ch] = data.get() + ch * numSamples;
+        }
+    }
+
+    void clear() {std::fill(data.get(), data.get() + numChannels * numSamples, SampleType(0));}
+
+    inline int getNumChannels() const {return numChannels;}
+    inline int getNumSamples() const {return numSamples;}
+    inline const SampleType* getReadPointer(int channel) const {return channels[channel];}
+    inline SampleType* getWritePointer(int channel) {return channels[channel];}
+    inline SampleType* const* getArrayOfWritePointers() {return channels.get();}
+    inline SampleType getSample(int channel, int index) const {return channels[channel][index];}
+    inline void setSample(int channel, int index, SampleType value) {channels[channel][index] = value;}
+
+private:
+    juce::HeapBlock<SampleType> data;
+    juce::HeapBlock<SampleType*> channels;
+    int numChannels, numSamples;
+    int allocatedSamples, allocatedChannels;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleBuffer)
+};
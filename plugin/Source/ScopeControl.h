@@ -0,0 +1,22 @@
+/*
+ ==============================================================================
+
+ ScopeControl.h
+ Created: 19 Oct 2026 10:11:26pm
+ Author:  Michael Nuzzo
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/* an atomic the audio thread publishes for the editor to read. each one gets
+   its own cache line, so writing one doesn't slow down reads of its neighbours */
+template <typename T>
+struct alignas(64) StatusValue : public std::atomic<T>
+{
+    using std::atomic<T>::atomic;
+    using std::atomic<T>::operator=;
+};
@@ -0,0 +1,227 @@
+/*
+  ==============================================================================
+
+    ScopeVectorOperations.cpp
+    Created: 19 Oct 2026 9:12:40am
+    Author:  Michael Nuzzo
+
+  ==============================================================================
+*/
+
+#include "ScopeVectorOperations.h"
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#elif JUCE_ARM && defined(__ARM_NEON)
+ #include <arm_neon.h>
+#endif
+
+/* log2(x) is split into the exponent plus log2 of a mantissa in [sqrt(1/2), sqrt(2)),
+   which the atanh series 2(t + t^3/3 + t^5/5 + t^7/7), t = (m-1)/(m+1) covers to ~1e-7 */
+static constexpr float dBPerOctave   = 6.0205999f;  // 20 * log10(2)
+static constexpr float dBPerNeper2   = 17.371779f;  // 2 * 20 / ln(10)
+static constexpr float sqrtTwo       = 1.4142135f;
+
+static inline float fastGainToDecibels(float gain, float minusInfinityDb) noexcept
+{
+    if(isnan(gain))
+    {
+        return gain;
+    }
+    if(gain <= 0)
+    {
+        return minusInfinityDb;
+    }
+
+    juce::uint32 bits;
+    gain = juce::jmax(gain, std::numeric_limits<float>::min()); // keep denormals out of the exponent
+    std::memcpy(&bits, &gain, sizeof(bits));
+    float exponent = float(int(bits >> 23) - 127);
+    bits = (bits & 0x007fffff) | 0x3f800000;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    if(m > sqrtTwo)
+    {
+        m *= 0.5f;
+        exponent += 1.f;
+    }
+
+    float t = (m - 1.f) / (m + 1.f);
+    float t2 = t * t;
+    float series = t * (1.f + t2 * (1.f / 3.f + t2 * (1.f / 5.f + t2 * (1.f / 7.f))));
+    return juce::jmax(minusInfinityDb, exponent * dBPerOctave + series * dBPerNeper2);
+}
+
+static inline bool isCrossing(float previous, float current, float threshold, bool rising) noexcept
+{
+    return rising ? (previous < threshold && current >= threshold)
+                  : (previous > threshold && current <= threshold);
+}
+
+int ScopeVectorOperations::findFirstCrossing(const float* src, int num, float threshold, bool rising, float previous) noexcept
+{
+    if(num <= 0)
+    {
+        return -1;
+    }
+
+    // the first sample pairs with the end of the last block
+    if(isCrossing(previous, src[0], threshold, rising))
+    {
+        return 0;
+    }
+
+    int i = 1;
+
+   #if JUCE_INTEL
+    // compare four (previous, current) pairs at once and only drop to scalar code on a hit
+    const __m128 t = _mm_set1_ps(threshold);
+    for(; i + 4 <= num; i += 4)
+    {
+        __m128 prev = _mm_loadu_ps(src + i - 1);
+        __m128 cur  = _mm_loadu_ps(src + i);
+        __m128 hit  = rising ? _mm_and_ps(_mm_cmplt_ps(prev, t), _mm_cmpge_ps(cur, t))
+                             : _mm_and_ps(_mm_cmpgt_ps(prev, t), _mm_cmple_ps(cur, t));
+        int mask = _mm_movemask_ps(hit);
+        if(mask != 0)
+        {
+            for(int k = 0; k < 4; k++)
+            {
+                if(mask & (1 << k))
+                {
+                    return i + k;
+                }
+            }
+        }
+    }
+   #elif JUCE_ARM && defined(__ARM_NEON)
+    const float32x4_t t = vdupq_n_f32(threshold);
+    for(; i + 4 <= num; i += 4)
+    {
+        float32x4_t prev = vld1q_f32(src + i - 1);
+        float32x4_t cur  = vld1q_f32(src + i);
+        uint32x4_t hit   = rising ? vandq_u32(vcltq_f32(prev, t), vcgeq_f32(cur, t))
+                                  : vandq_u32(vcgtq_f32(prev, t), vcleq_f32(cur, t));
+        uint32x2_t any   = vorr_u32(vget_low_u32(hit), vget_high_u32(hit));
+        if(vget_lane_u32(vpmax_u32(any, any), 0) != 0)
+        {
+            for(int k = 0; k < 4; k++)
+            {
+                if(isCrossing(src[i + k - 1], src[i + k], threshold, rising))
+                {
+                    return i + k;
+                }
+            }
+        }
+    }
+   #endif
+
+    for(; i < num; i++)
+    {
+        if(isCrossing(src[i - 1], src[i], threshold, rising))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+void ScopeVectorOperations::fillColumn(juce::uint32* dest, int stride, int num, juce::uint32 value) noexcept
+{
+    // a column can't be loaded as a vector, so unroll to keep the stores back to back
+    int i = 0;
+    for(; i + 4 <= num; i += 4)
+    {
+        dest[0]          = value;
+        dest[stride]     = value;
+        dest[stride * 2] = value;
+        dest[stride * 3] = value;
+        dest += stride * 4;
+    }
+    for(; i < num; i++)
+    {
+        *dest = value;
+        dest += stride;
+    }
+}
+
+void ScopeVectorOperations::gainToDecibels(float* dest, const float* src, int num, float minusInfinityDb) noexcept
+{
+    int i = 0;
+
+   #if JUCE_INTEL
+    const __m128  zero     = _mm_setzero_ps();
+    const __m128  one      = _mm_set1_ps(1.f);
+    const __m128  half     = _mm_set1_ps(0.5f);
+    const __m128  root2    = _mm_set1_ps(sqrtTwo);
+    const __m128  smallest = _mm_set1_ps(std::numeric_limits<float>::min());
+    const __m128  floorDb  = _mm_set1_ps(minusInfinityDb);
+    const __m128i bias     = _mm_set1_epi32(127);
+    const __m128i mantissa = _mm_set1_epi32(0x007fffff);
+    const __m128i oneBits  = _mm_set1_epi32(0x3f800000);
+    for(; i + 4 <= num; i += 4)
+    {
+        __m128 gain  = _mm_loadu_ps(src + i);
+        __m128 valid = _mm_cmpgt_ps(gain, zero);
+        __m128 isNan = _mm_cmpunord_ps(gain, gain);
+        __m128i bits = _mm_castps_si128(_mm_max_ps(gain, smallest));
+
+        __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), bias));
+        __m128 m        = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mantissa), oneBits));
+        __m128 big      = _mm_cmpgt_ps(m, root2);
+        m        = _mm_sub_ps(m, _mm_and_ps(big, _mm_mul_ps(m, half)));
+        exponent = _mm_add_ps(exponent, _mm_and_ps(big, one));
+
+        __m128 t      = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one));
+        __m128 t2     = _mm_mul_ps(t, t);
+        __m128 series = _mm_add_ps(_mm_set1_ps(1.f / 5.f), _mm_mul_ps(t2, _mm_set1_ps(1.f / 7.f)));
+        series = _mm_add_ps(_mm_set1_ps(1.f / 3.f), _mm_mul_ps(t2, series));
+        series = _mm_mul_ps(t, _mm_add_ps(one, _mm_mul_ps(t2, series)));
+
+        __m128 db = _mm_add_ps(_mm_mul_ps(exponent, _mm_set1_ps(dBPerOctave)), _mm_mul_ps(series, _mm_set1_ps(dBPerNeper2)));
+        db = _mm_max_ps(db, floorDb);
+        db = _mm_or_ps(_mm_and_ps(valid, db), _mm_andnot_ps(valid, floorDb));
+        _mm_storeu_ps(dest + i, _mm_or_ps(_mm_and_ps(isNan, gain), _mm_andnot_ps(isNan, db)));
+    }
+   #elif JUCE_ARM && defined(__ARM_NEON)
+    const float32x4_t zero     = vdupq_n_f32(0.f);
+    const float32x4_t one      = vdupq_n_f32(1.f);
+    const float32x4_t root2    = vdupq_n_f32(sqrtTwo);
+    const float32x4_t smallest = vdupq_n_f32(std::numeric_limits<float>::min());
+    const float32x4_t floorDb  = vdupq_n_f32(minusInfinityDb);
+    for(; i + 4 <= num; i += 4)
+    {
+        float32x4_t gain  = vld1q_f32(src + i);
+        uint32x4_t  valid = vcgtq_f32(gain, zero);
+        uint32x4_t  isNum = vceqq_f32(gain, gain);
+        uint32x4_t  bits  = vreinterpretq_u32_f32(vmaxq_f32(gain, smallest));
+
+        float32x4_t exponent = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(127)));
+        float32x4_t m        = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007fffff)), vdupq_n_u32(0x3f800000)));
+        uint32x4_t  big      = vcgtq_f32(m, root2);
+        m        = vbslq_f32(big, vmulq_n_f32(m, 0.5f), m);
+        exponent = vbslq_f32(big, vaddq_f32(exponent, one), exponent);
+
+        // no divide on 32 bit arm, so refine the reciprocal estimate twice instead
+        float32x4_t denominator = vaddq_f32(m, one);
+        float32x4_t reciprocal  = vrecpeq_f32(denominator);
+        reciprocal = vmulq_f32(vrecpsq_f32(denominator, reciprocal), reciprocal);
+        reciprocal = vmulq_f32(vrecpsq_f32(denominator, reciprocal), reciprocal);
+        float32x4_t t  = vmulq_f32(vsubq_f32(m, one), reciprocal);
+        float32x4_t t2 = vmulq_f32(t, t);
+        float32x4_t series = vmlaq_f32(vdupq_n_f32(1.f / 5.f), t2, vdupq_n_f32(1.f / 7.f));
+        series = vmlaq_f32(vdupq_n_f32(1.f / 3.f), t2, series);
+        series = vmulq_f32(t, vmlaq_f32(one, t2, series));
+
+        float32x4_t db = vmlaq_f32(vmulq_n_f32(exponent, dBPerOctave), series, vdupq_n_f32(dBPerNeper2));
+        db = vbslq_f32(valid, vmaxq_f32(db, floorDb), floorDb);
+        vst1q_f32(dest + i, vbslq_f32(isNum, db, gain));
+    }
+   #endif
+
+    for(; i < num; i++)
+    {
+        dest[i] = fastGainToDecibels(src[i], minusInfinityDb);
+    }
+}
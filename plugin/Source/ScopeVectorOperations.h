@@ -0,0 +1,28 @@
+/*
+ ==============================================================================
+
+ ScopeVectorOperations.h
+ Created: 19 Oct 2026 9:12:40am
+ Author:  Michael Nuzzo
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/* vectorised helpers for the scope pipeline, in the spirit of juce::FloatVectorOperations */
+struct ScopeVectorOperations
+{
+    // returns the index of the first sample that crosses the threshold in the given direction, or -1.
+    // previous is the sample that came just before src[0] (use NAN if there isn't one)
+    static int findFirstCrossing(const float* src, int num, float threshold, bool rising, float previous) noexcept;
+
+    // writes value into num pixels going down a column, stride is the image line stride in pixels
+    static void fillColumn(juce::uint32* dest, int stride, int num, juce::uint32 value) noexcept;
+
+    // like juce::Decibels::gainToDecibels over a whole span, good to about 0.001 dB, except that NAN stays NAN.
+    // dest and src may be the same
+    static void gainToDecibels(float* dest, const float* src, int num, float minusInfinityDb = -100.f) noexcept;
+};
@@ -0,0 +1,211 @@
+/*
+  ==============================================================================
+
+    SpanMapper.cpp
+    Created: 19 Oct 2026 7:34:12pm
+    Author:  Michael Nuzzo
+
+  ==============================================================================
+*/
+
+#include "SpanMapper.h"
+
+SpanMapper::SpanMapper(int tracesPerColumn) : numTraces(tracesPerColumn), writeIndex(0), compMode(false), yMin(0.f), yMax(0.f), height(0)
+{
+    gains.calloc(size_t(numTraces));
+    history.setSize(numTraces * 3, 1);
+    reset();
+}
+
+SpanMapper::~SpanMapper()
+{
+}
+
+void SpanMapper::prepare(int maxPixels)
+{
+    history.setSize(numTraces * 3, maxPixels + 1);
+    reset();
+}
+
+void SpanMapper::reset()
+{
+    // NAN never maps to anything, so an empty history draws nothing
+    for(int ch = 0; ch < history.getNumChannels(); ch++)
+    {
+        juce::FloatVectorOperations::fill(history.getWritePointer(ch), NAN, history.getNumSamples());
+    }
+    writeIndex = 0;
+}
+
+bool SpanMapper::setMapping(bool isCompMode, const float* traceGains, float newYMin, float newYMax, int newHeight)
+{
+    bool changed = isCompMode != compMode || newYMin != yMin || newYMax != yMax || newHeight != height;
+    for(int t = 0; t < numTraces - 1; t++)
+    {
+        changed = changed || traceGains[t] != gains[t];
+        gains[t] = traceGains[t];
+    }
+
+    compMode = isCompMode;
+    yMin = newYMin;
+    yMax = newYMax;
+    height = newHeight;
+
+    return changed;
+}
+
+void SpanMapper::push(const juce::AudioBuffer<float>& columns, int numColumns, SampleBuffer<juce::int16>& spans)
+{
+    jassert(columns.getNumChannels() >= history.getNumChannels() && spans.getNumSamples() >= numColumns);
+    int size = history.getNumSamples();
+
+    // copy everything in first so the dB conversion runs over whole runs of columns
+    int first = writeIndex;
+    for(int done = 0; done < numColumns;)
+    {
+        int num = juce::jmin(numColumns - done, size - writeIndex);
+        store(columns, done, num);
+        done += num;
+        writeIndex = (writeIndex + num) % size;
+    }
+
+    // each span joins a column to the one after it, so the newest column is drawn once the next one arrives
+    for(int i = 0; i < numColumns; i++)
+    {
+        int current = (first + i) % size;
+        mapColumn((current + size - 1) % size, current, spans, i);
+    }
+}
+
+void SpanMapper::store(const juce::AudioBuffer<float>& columns, int start, int num)
+{
+    for(int ch = 0; ch < history.getNumChannels(); ch++)
+    {
+        auto dest = history.getWritePointer(ch, writeIndex);
+        if(ch % numTraces == numTraces - 1)
+        {
+            // the gain trace is only ever shown in dB
+            ScopeVectorOperations::gainToDecibels(dest, columns.getReadPointer(ch, start), num, SILENT_DB);
+        }
+        else
+        {
+            juce::FloatVectorOperations::copy(dest, columns.getReadPointer(ch, start), num);
+        }
+    }
+}
+
+void SpanMapper::remap(SampleBuffer<juce::int16>& spans, int numColumns)
+{
+    int size = history.getNumSamples();
+    numColumns = juce::jmin(numColumns, size - 1, spans.getNumSamples());
+
+    int current = (writeIndex + size - numColumns) % size;
+    for(int i = 0; i < numColumns; i++)
+    {
+        mapColumn((current + size - 1) % size, current, spans, i);
+        current = (current + 1) % size;
+    }
+}
+
+void SpanMapper::mapColumn(int previous, int current, SampleBuffer<juce::int16>& spans, int dest)
+{
+    for(int t = 0; t < numTraces; t++)
+    {
+        auto val = history.getReadPointer(t);
+        auto min = history.getReadPointer(numTraces + t);
+        auto hold = history.getReadPointer(numTraces * 2 + t);
+
+        // compression mode only shows the gain trace, oscilloscope mode shows the rest
+        bool shown = compMode == (t == numTraces - 1);
+        int top = 1, bottom = 0, holdTop = 1, holdBottom = 0;
+
+        // the gain can only be drawn in dB where both ends are above zero
+        auto isDrawable = [&](float v, float vNext)
+        {
+            return compMode ? (v > SILENT_DB && vNext > SILENT_DB) : !(isnan(v) || isnan(vNext));
+        };
+
+        if(shown && isDrawable(val[previous], val[current]))
+        {
+            float d1, d2;
+            prepareFilledLine(val[previous], val[current], min[previous], min[current], d1, d2);
+            int y1 = valToCoord(d1, t);
+            int y2 = valToCoord(d2, t);
+            top = juce::jmin(y1, y2);
+            bottom = juce::jmax(y1, y2);
+        }
+
+        if(shown && isDrawable(hold[previous], hold[current]))
+        {
+            int y1 = valToCoord(hold[previous], t);
+            int y2 = valToCoord(hold[current], t);
+            holdTop = juce::jmin(y1, y2);
+            holdBottom = juce::jmax(y1, y2);
+        }
+
+        // valToCoord keeps everything inside the window, which is far short of what an int16 holds
+        spans.setSample(t * 2, dest, juce::int16(top));
+        spans.setSample(t * 2 + 1, dest, juce::int16(bottom));
+        spans.setSample(numTraces * 2 + t * 2, dest, juce::int16(holdTop));
+        spans.setSample(numTraces * 2 + t * 2 + 1, dest, juce::int16(holdBottom));
+    }
+}
+
+int SpanMapper::valToCoord(float v, int trace)
+{
+    int h = height - 1;
+    if(compMode)
+    {
+        return juce::jlimit(0, h, int(juce::jmap(v, yMax, yMin, 0.f, float(h))));
+    }
+    return juce::jlimit(0, h, int(juce::jmap(v * gains[trace], 1.f, -1.f, 0.f, float(h))));
+}
+
+void SpanMapper::prepareFilledLine(float v, float vNext, float vMin, float vMinNext, float &out1, float &out2)
+{
+    if(!isnan(vMin))
+    {
+        out1 = v;
+        out2 = vMin;
+
+        if(!isnan(vMinNext))
+        {
+            if(v < vMinNext)
+            {
+                out1 = vMinNext;
+            }
+            if(vMin > vNext)
+            {
+                out2 = vNext;
+            }
+        }
+        else
+        {
+            if(v < vNext)
+            {
+                out1 = vNext;
+            }
+            if(vMin > vNext)
+            {
+                out2 = vNext;
+            }
+        }
+    }
+    else
+    {
+        out1 = v;
+        out2 = vNext;
+
+        if(!isnan(vMinNext))
+        {
+            if(v < vMinNext)
+            {
+                out2 = vMinNext;
+                if(v > vNext)
+                {
+                    out1 = vNext;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,55 @@
+/*
+ ==============================================================================
+
+ SpanMapper.h
+ Created: 19 Oct 2026 7:34:12pm
+ Author:  Michael Nuzzo
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ScopeVectorOperations.h"
+#include "SampleBuffer.h"
+
+/* turns decimated columns into the vertical pixel span each trace covers,
+   so the editor only has to fill them in. a column with nothing to draw
+   has its top below its bottom. the spans are whole pixels, so they go out
+   as int16 */
+class SpanMapper
+{
+public:
+    SpanMapper(int tracesPerColumn);
+    ~SpanMapper();
+
+    void prepare(int maxPixels);
+    void reset();
+    bool setMapping(bool isCompMode, const float* traceGains, float newYMin, float newYMax, int newHeight);
+
+    void push(const juce::AudioBuffer<float>& columns, int numColumns, SampleBuffer<juce::int16>& spans);
+    void remap(SampleBuffer<juce::int16>& spans, int numColumns);
+    inline int getNumChannels() {return numTraces * 4;}
+
+    static void prepareFilledLine(float v, float vNext, float vMin, float vMinNext, float &out1, float &out2);
+
+private:
+    void store(const juce::AudioBuffer<float>& columns, int start, int num);
+    void mapColumn(int previous, int current, SampleBuffer<juce::int16>& spans, int dest);
+    int valToCoord(float v, int trace);
+
+    static constexpr float SILENT_DB = -1000.f; // below anything a positive float can reach, so we can still tell a gain of zero
+
+    const int numTraces; // each column has a value, min and max-hold channel per trace
+    juce::AudioBuffer<float> history; // the last maxPixels + 1 decimated columns, so the whole window can be remapped. the gain trace is kept in dB
+    int writeIndex; // history slot the next column goes in
+    /* mapping */
+    bool compMode;
+    juce::HeapBlock<float> gains; // linear gain per audio trace
+    float yMin, yMax;
+    int height; // window height in display pixels
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpanMapper)
+};
@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    SweepAverager.cpp
+    Created: 19 Oct 2026 11:05:17am
+    Author:  Michael Nuzzo
+
+  ==============================================================================
+*/
+
+#include "SweepAverager.h"
+
+SweepAverager::SweepAverager(int tracesPerSweep) : numTraces(tracesPerSweep), numSweeps(1), numStored(0), writeIndex(0)
+{
+}
+
+SweepAverager::~SweepAverager()
+{
+}
+
+void SweepAverager::prepare(int newNumSweeps, int numPixels)
+{
+    // only as much history as these settings need, a new averager is built whenever they change
+    numSweeps = juce::jmax(1, newNumSweeps);
+    history.setSize(numSweeps * numTraces * 2, numPixels);
+    sum.setSize(numTraces * 2, numPixels);
+    hold.setSize(numTraces, numPixels);
+    reset();
+}
+
+void SweepAverager::reset()
+{
+    sum.clear();
+    for(int ch = 0; ch < hold.getNumChannels(); ch++)
+    {
+        juce::FloatVectorOperations::fill(hold.getWritePointer(ch), std::numeric_limits<float>::lowest(), hold.getNumSamples());
+    }
+    numStored = 0;
+    writeIndex = 0;
+}
+
+void SweepAverager::addSweep(const juce::AudioBuffer<float>& sweep, bool hasMinMax)
+{
+    int numPixels = sum.getNumSamples();
+    int numChannels = numTraces * 2;
+    int slot = writeIndex * numChannels;
+    jassert(sweep.getNumChannels() >= numChannels && sweep.getNumSamples() >= numPixels);
+
+    // the oldest sweep falls out of the running sum once we are full
+    if(numStored == numSweeps)
+    {
+        for(int ch = 0; ch < numChannels; ch++)
+        {
+            juce::FloatVectorOperations::subtract(sum.getWritePointer(ch), history.getReadPointer(slot + ch), numPixels);
+        }
+    }
+    else
+    {
+        numStored++;
+    }
+
+    for(int ch = 0; ch < numChannels; ch++)
+    {
+        auto src = sweep.getReadPointer(ch);
+        auto dst = history.getWritePointer(slot + ch);
+
+        // pixels without a min (lttb, or a single sample) are drawn as a line, so their min is the value itself.
+        // the value channels come first, so theirs are already cleaned up
+        const float* value = ch >= numTraces ? history.getReadPointer(slot + ch - numTraces) : nullptr;
+        for(int i = 0; i < numPixels; i++)
+        {
+            if(value != nullptr && std::isnan(src[i]))
+            {
+                dst[i] = value[i];
+                continue;
+            }
+
+            // a silent input gives us inf or NAN ratios, which would poison the running sum
+            dst[i] = std::isfinite(src[i]) ? src[i] : 0.f;
+        }
+        juce::FloatVectorOperations::add(sum.getWritePointer(ch), dst, numPixels);
+    }
+
+    for(int t = 0; t < numTraces; t++)
+    {
+        auto h = hold.getWritePointer(t);
+        juce::FloatVectorOperations::max(h, h, history.getReadPointer(slot + t), numPixels);
+
+        // a missing min was replaced by the value above rather than 0, so it can't floor the hold
+        if(hasMinMax)
+        {
+            juce::FloatVectorOperations::max(h, h, history.getReadPointer(slot + numTraces + t), numPixels);
+        }
+    }
+
+    writeIndex = (writeIndex + 1) % numSweeps;
+
+    // rebuild the sum once per lap so rounding errors from the add/subtract pairs can't build up
+    if(writeIndex == 0 && numStored == numSweeps)
+    {
+        recalculateSum();
+    }
+}
+
+void SweepAverager::getMean(juce::AudioBuffer<float>& dest, bool hasMinMax)
+{
+    int numPixels = sum.getNumSamples();
+    float scale = numStored > 0 ? 1.f / float(numStored) : 0.f;
+
+    for(int ch = 0; ch < numTraces * 2; ch++)
+    {
+        if(ch >= numTraces && !hasMinMax)
+        {
+            // there is no min channel to average, so tell the display to draw a line instead
+            juce::FloatVectorOperations::fill(dest.getWritePointer(ch), NAN, numPixels);
+        }
+        else
+        {
+            juce::FloatVectorOperations::multiply(dest.getWritePointer(ch), sum.getReadPointer(ch), scale, numPixels);
+        }
+    }
+}
+
+void SweepAverager::getHold(juce::AudioBuffer<float>& dest, int destChannel)
+{
+    for(int t = 0; t < numTraces; t++)
+    {
+        dest.copyFrom(destChannel + t, 0, hold, t, 0, hold.getNumSamples());
+    }
+}
+
+void SweepAverager::recalculateSum()
+{
+    int numPixels = sum.getNumSamples();
+    int numChannels = numTraces * 2;
+
+    sum.clear();
+    for(int s = 0; s < numStored; s++)
+    {
+        for(int ch = 0; ch < numChannels; ch++)
+        {
+            juce::FloatVectorOperations::add(sum.getWritePointer(ch), history.getReadPointer(s * numChannels + ch), numPixels);
+        }
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ ==============================================================================
+
+ SweepAverager.h
+ Created: 19 Oct 2026 11:05:17am
+ Author:  Michael Nuzzo
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class SweepAverager
+{
+public:
+    SweepAverager(int tracesPerSweep);
+    ~SweepAverager();
+
+    void prepare(int newNumSweeps, int numPixels);
+    void reset();
+
+    void addSweep(const juce::AudioBuffer<float>& sweep, bool hasMinMax);
+    void getMean(juce::AudioBuffer<float>& dest, bool hasMinMax);
+    void getHold(juce::AudioBuffer<float>& dest, int destChannel);
+    inline int getNumStored() {return numStored;}
+
+private:
+    void recalculateSum();
+
+    const int numTraces; // traces per sweep, each with a value and a min channel
+    juce::AudioBuffer<float> history; // the last numSweeps sweeps, numTraces * 2 channels each
+    juce::AudioBuffer<float> sum; // running sum of everything in the history
+    juce::AudioBuffer<float> hold; // highest value seen per pixel since the last reset
+    int numSweeps;
+    int numStored;
+    int writeIndex; // history slot the next sweep goes in (the oldest once we are full)
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SweepAverager)
+};
@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    TilePool.cpp
+    Created: 19 Oct 2026 8:14:37pm
+    Author:  Michael Nuzzo
+
+  ==============================================================================
+*/
+
+#include "TilePool.h"
+
+TilePool::TilePool() : numWorkers(juce::jlimit(0, 7, juce::SystemStats::getNumCpus() - 1)), pool(juce::jmax(1, numWorkers)), numPending(0)
+{
+}
+
+TilePool::~TilePool()
+{
+    pool.removeAllJobs(true, 1000);
+}
+
+void TilePool::run(int startColumn, int endColumn, int height, const std::function<void(int, int)>& drawTile)
+{
+    int numColumns = endColumn - startColumn;
+    if(numColumns <= 0)
+    {
+        return;
+    }
+
+    // small windows are quicker to draw than to hand out
+    int numTiles = juce::jlimit(1, numWorkers + 1, int(juce::int64(numColumns) * juce::jmax(1, height) / MIN_TILE_PIXELS));
+    if(numTiles == 1)
+    {
+        drawTile(startColumn, endColumn);
+        return;
+    }
+
+    // tiles never share a column, so they can be drawn without any locking
+    auto tileStart = [=](int tile) {return startColumn + int(juce::int64(numColumns) * tile / numTiles);};
+
+    finished.reset();
+    numPending = numTiles - 1;
+    for(int tile = 1; tile < numTiles; tile++)
+    {
+        int start = tileStart(tile);
+        int end = tileStart(tile + 1);
+        pool.addJob([this, &drawTile, start, end]
+        {
+            drawTile(start, end);
+            if(--numPending == 0)
+            {
+                finished.signal();
+            }
+        });
+    }
+
+    // draw the first tile ourselves while the workers get going
+    drawTile(startColumn, tileStart(1));
+    finished.wait();
+}
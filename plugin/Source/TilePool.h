@@ -0,0 +1,36 @@
+/*
+ ==============================================================================
+
+ TilePool.h
+ Created: 19 Oct 2026 8:14:37pm
+ Author:  Michael Nuzzo
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/* splits the scope window into column tiles and draws them on a few worker
+   threads at once. shared by every open editor through a juce::SharedResourcePointer */
+class TilePool
+{
+public:
+    TilePool();
+    ~TilePool();
+
+    void run(int startColumn, int endColumn, int height, const std::function<void(int, int)>& drawTile);
+    inline int getNumWorkers() {return numWorkers;}
+
+    static constexpr int MIN_TILE_PIXELS = 128 * 1024; // below this a tile isn't worth handing to another thread
+
+private:
+    int numWorkers; // the calling thread always draws one tile itself, so this is one less than the core count
+    juce::ThreadPool pool;
+    std::atomic<int> numPending; // tiles the workers haven't finished yet
+    juce::WaitableEvent finished;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TilePool)
+};
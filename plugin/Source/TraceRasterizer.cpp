@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    TraceRasterizer.cpp
+    Created: 19 Oct 2026 5:10:26pm
+    Author:  Michael Nuzzo
+
+  ==============================================================================
+*/
+
+#include "TraceRasterizer.h"
+
+TraceRasterizer::TraceRasterizer() : pixels(nullptr), lineStride(0), width(0), height(0)
+{
+}
+
+TraceRasterizer::~TraceRasterizer()
+{
+}
+
+bool TraceRasterizer::prepare(int newWidth, int newHeight)
+{
+    if(newWidth == width && newHeight == height)
+    {
+        return false;
+    }
+
+    width = newWidth;
+    height = newHeight;
+    image = juce::Image(juce::Image::ARGB, juce::jmax(1, width), juce::jmax(1, height), true, juce::SoftwareImageType());
+
+    // software pixel data doesn't move once allocated, so we only need to look it up once
+    juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::readWrite);
+    pixels = bitmap.data;
+    lineStride = bitmap.lineStride;
+
+    return true;
+}
+
+void TraceRasterizer::clear(juce::Colour background)
+{
+    auto value = background.getPixelARGB().getNativeARGB();
+    for(int y = 0; y < height; y++)
+    {
+        auto line = reinterpret_cast<juce::uint32*>(pixels + y * lineStride);
+        std::fill(line, line + width, value);
+    }
+}
+
+void TraceRasterizer::scroll(int numColumns, juce::Colour background)
+{
+    if(numColumns <= 0)
+    {
+        return;
+    }
+    if(numColumns >= width)
+    {
+        clear(background);
+        return;
+    }
+
+    // slide every line left and blank the columns that open up on the right
+    auto value = background.getPixelARGB().getNativeARGB();
+    int numKept = width - numColumns;
+    for(int y = 0; y < height; y++)
+    {
+        auto line = reinterpret_cast<juce::uint32*>(pixels + y * lineStride);
+        std::memmove(line, line + numColumns, size_t(numKept) * sizeof(juce::uint32));
+        std::fill(line + numKept, line + width, value);
+    }
+}
+
+void TraceRasterizer::fillSpan(int x, int yTop, int yBottom, juce::Colour colour)
+{
+    if(!juce::isPositiveAndBelow(x, width))
+    {
+        return;
+    }
+
+    yTop = juce::jlimit(0, height - 1, yTop);
+    yBottom = juce::jlimit(0, height - 1, yBottom);
+
+    auto dest = reinterpret_cast<juce::uint32*>(pixels + yTop * lineStride) + x;
+    ScopeVectorOperations::fillColumn(dest, lineStride / 4, yBottom - yTop + 1, colour.getPixelARGB().getNativeARGB());
+}
+
+void TraceRasterizer::blendSpan(int x, int yTop, int yBottom, juce::Colour colour)
+{
+    if(!juce::isPositiveAndBelow(x, width))
+    {
+        return;
+    }
+
+    yTop = juce::jlimit(0, height - 1, yTop);
+    yBottom = juce::jlimit(0, height - 1, yBottom);
+
+    auto src = colour.getPixelARGB();
+    for(int y = yTop; y <= yBottom; y++)
+    {
+        reinterpret_cast<juce::PixelARGB*>(pixels + y * lineStride + x * 4)->blend(src);
+    }
+}
@@ -0,0 +1,41 @@
+/*
+ ==============================================================================
+
+ TraceRasterizer.h
+ Created: 19 Oct 2026 5:10:26pm
+ Author:  Michael Nuzzo
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ScopeVectorOperations.h"
+
+/* draws the scope traces straight into the pixels of a cached image,
+   so a frame costs one drawImageAt instead of a fillRect per column */
+class TraceRasterizer
+{
+public:
+    TraceRasterizer();
+    ~TraceRasterizer();
+
+    bool prepare(int newWidth, int newHeight);
+    void clear(juce::Colour background);
+    void scroll(int numColumns, juce::Colour background);
+    void fillSpan(int x, int yTop, int yBottom, juce::Colour colour);
+    void blendSpan(int x, int yTop, int yBottom, juce::Colour colour);
+    inline juce::Image& getImage() {return image;}
+    inline int getWidth() {return width;}
+    inline int getHeight() {return height;}
+
+private:
+    juce::Image image; // always a software image so its pixels stay put between frames
+    juce::uint8* pixels; // top-left pixel of the image
+    int lineStride; // bytes per line
+    int width, height;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TraceRasterizer)
+};
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    TriggerDetector.cpp
+    Created: 19 Oct 2026 9:40:02am
+    Author:  Michael Nuzzo
+
+  ==============================================================================
+*/
+
+#include "TriggerDetector.h"
+
+TriggerDetector::TriggerDetector() : level(0.f), rising(true), lastSample(NAN), armedFrom(0)
+{
+}
+
+TriggerDetector::~TriggerDetector()
+{
+}
+
+void TriggerDetector::setParameters(float newLevel, bool isRising)
+{
+    level = newLevel;
+    rising = isRising;
+}
+
+void TriggerDetector::reset(juce::int64 armFrom)
+{
+    lastSample = NAN;
+    armedFrom = armFrom;
+}
+
+void TriggerDetector::rearm(juce::int64 armFrom)
+{
+    armedFrom = armFrom;
+}
+
+juce::int64 TriggerDetector::scan(const float* data, int numSamples, juce::int64 firstSample)
+{
+    if(numSamples <= 0)
+    {
+        return -1;
+    }
+
+    juce::int64 found = -1;
+
+    // skip anything before we are armed (holdoff, or a sweep is still being collected)
+    int offset = int(juce::jlimit<juce::int64>(0, numSamples, armedFrom - firstSample));
+    if(offset < numSamples)
+    {
+        float previous = offset > 0 ? data[offset - 1] : lastSample;
+        int index = ScopeVectorOperations::findFirstCrossing(data + offset, numSamples - offset, level, rising, previous);
+        if(index >= 0)
+        {
+            found = firstSample + offset + index;
+            // stay disarmed until the sweep that this starts has been collected
+            armedFrom = std::numeric_limits<juce::int64>::max();
+        }
+    }
+
+    lastSample = data[numSamples - 1];
+
+    return found;
+}
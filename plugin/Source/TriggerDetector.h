@@ -0,0 +1,35 @@
+/*
+ ==============================================================================
+
+ TriggerDetector.h
+ Created: 19 Oct 2026 9:40:02am
+ Author:  Michael Nuzzo
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ScopeVectorOperations.h"
+
+class TriggerDetector
+{
+public:
+    TriggerDetector();
+    ~TriggerDetector();
+
+    void setParameters(float newLevel, bool isRising);
+    void reset(juce::int64 armFrom = 0);
+    void rearm(juce::int64 armFrom);
+    juce::int64 scan(const float* data, int numSamples, juce::int64 firstSample);
+
+private:
+    float level;
+    bool rising;
+    float lastSample; // last sample of the previous block so we catch crossings on block boundaries
+    juce::int64 armedFrom; // first sample we are allowed to trigger on
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TriggerDetector)
+};